@@ -0,0 +1,15 @@
+# lz4 build options
+set(LZ4_BUILD_CLI OFF)
+set(LZ4_BUILD_LEGACY_LZ4C OFF)
+set(BUILD_STATIC_LIBS ON)
+
+# fetch and build lz4 (its cmake project lives in a sub-folder)
+FetchContent_Declare(lz4
+    GIT_REPOSITORY "https://github.com/lz4/lz4.git"
+    GIT_TAG "v1.10.0"
+    GIT_SHALLOW ON
+    SOURCE_SUBDIR "build/cmake")
+FetchContent_MakeAvailable(lz4)
+target_link_libraries(${PROJECT_NAME} PRIVATE lz4_static)
+target_include_directories(${PROJECT_NAME} PRIVATE "${lz4_SOURCE_DIR}/lib")
+target_compile_definitions(${PROJECT_NAME} PRIVATE ARCHIVE_LZ4)
@@ -0,0 +1,169 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <fmt/base.h>
+#include <fmt/format.h>
+
+// heap allocations per subsystem, only counted in builds with the ALLOC_TRACKING option,
+// where src/alloc_tracking.cpp replaces the global operator new and delete and reports here
+// a scope tags everything its thread allocates, a no-alloc region flags every allocation inside it
+// without the option scopes and regions compile to nothing
+namespace AllocTracker {
+    enum class Subsystem : uint8_t { eOther, eRender, eSim, eAudio, eAssets, eUI, eCount };
+    static constexpr size_t subsystem_count = static_cast<size_t>(Subsystem::eCount);
+    static constexpr std::array<const char*, subsystem_count> subsystem_names = { "other", "render", "sim", "audio", "assets", "ui" };
+    static constexpr uint32_t max_violations = 16; // kept for the report, later ones are only counted
+#ifdef ALLOC_TRACKING
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    // written from any thread inside operator new and delete, so nothing here may allocate
+    struct Counters {
+        std::atomic<uint64_t> allocations = 0;
+        std::atomic<uint64_t> bytes = 0;
+        std::atomic<int64_t> live_bytes = 0;
+        std::atomic<uint64_t> frame_allocations = 0;
+        std::atomic<uint64_t> frame_bytes = 0;
+    };
+    struct Violation {
+        const char* region_p;
+        Subsystem subsystem;
+        size_t bytes;
+        uint64_t frame;
+    };
+    struct Data {
+        std::array<Counters, subsystem_count> counters;
+        std::atomic<uint64_t> violations = 0;
+        std::array<Violation, max_violations> violation_log = {};
+        // the last finished frame, main thread only
+        std::array<uint64_t, subsystem_count> last_frame_allocations = {};
+        std::array<uint64_t, subsystem_count> last_frame_bytes = {};
+        uint64_t reported_violations = 0;
+        std::atomic<uint64_t> frame = 0;
+
+        static Data& get() {
+            static Data instance;
+            return instance;
+        }
+    };
+
+    struct ThreadState {
+        Subsystem subsystem = Subsystem::eOther;
+        uint32_t no_alloc_depth = 0;
+        const char* region_p = nullptr;
+    };
+    inline auto thread_state() -> ThreadState& {
+        thread_local ThreadState state;
+        return state;
+    }
+
+    // called by the hooks, returns the subsystem to hand back to on_free
+    inline auto on_allocate(size_t bytes) -> Subsystem {
+        Data& data = Data::get();
+        ThreadState& state = thread_state();
+        Counters& counters = data.counters[static_cast<size_t>(state.subsystem)];
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+        counters.live_bytes.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+        counters.frame_allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.frame_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        if (state.no_alloc_depth > 0) {
+            uint64_t index = data.violations.fetch_add(1, std::memory_order_relaxed);
+            if (index < max_violations) data.violation_log[index] = { state.region_p, state.subsystem, bytes, data.frame.load(std::memory_order_relaxed) };
+        }
+        return state.subsystem;
+    }
+    inline void on_free(size_t bytes, Subsystem subsystem) {
+        Data::get().counters[static_cast<size_t>(subsystem)].live_bytes.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+    }
+
+    // tags the allocations of this thread until the end of the enclosing block
+    struct Scope {
+        Scope(Subsystem subsystem) {
+            if constexpr (!enabled) return;
+            ThreadState& state = thread_state();
+            _parent = state.subsystem;
+            state.subsystem = subsystem;
+        }
+        ~Scope() {
+            if constexpr (enabled) thread_state().subsystem = _parent;
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Subsystem _parent = Subsystem::eOther;
+    };
+    // every allocation of this thread until the end of the enclosing block is a violation
+    struct NoAlloc {
+        NoAlloc(const char* region_p) {
+            if constexpr (!enabled) return;
+            ThreadState& state = thread_state();
+            _parent_p = state.region_p;
+            state.region_p = region_p;
+            state.no_alloc_depth++;
+        }
+        ~NoAlloc() {
+            if constexpr (!enabled) return;
+            ThreadState& state = thread_state();
+            state.no_alloc_depth--;
+            state.region_p = _parent_p;
+        }
+        NoAlloc(const NoAlloc&) = delete;
+        NoAlloc& operator=(const NoAlloc&) = delete;
+
+    private:
+        const char* _parent_p = nullptr;
+    };
+
+    // keep the frame's counts for display and print violations that happened in it
+    inline void end_frame() {
+        if constexpr (!enabled) return;
+        Data& data = Data::get();
+        for (size_t i = 0; i < subsystem_count; i++) {
+            data.last_frame_allocations[i] = data.counters[i].frame_allocations.exchange(0, std::memory_order_relaxed);
+            data.last_frame_bytes[i] = data.counters[i].frame_bytes.exchange(0, std::memory_order_relaxed);
+        }
+        uint64_t violations = data.violations.load(std::memory_order_relaxed);
+        for (uint64_t i = data.reported_violations; i < std::min<uint64_t>(violations, max_violations); i++) {
+            const Violation& violation = data.violation_log[i];
+            fmt::println("Heap allocation of {} bytes in no-alloc region {} ({}), frame {}", violation.bytes, violation.region_p, subsystem_names[static_cast<size_t>(violation.subsystem)], violation.frame);
+        }
+        data.reported_violations = violations;
+        data.frame++;
+    }
+
+    // totals per subsystem and the remembered violations
+    inline bool write_report(const std::string& path) {
+        if constexpr (!enabled) return false;
+        Data& data = Data::get();
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            fmt::println("Failed to write allocation report: {}", path);
+            return false;
+        }
+        file << fmt::format("{{\n  \"frames\": {},\n  \"violations\": {},\n  \"subsystems\": [\n", data.frame.load(), data.violations.load());
+        for (size_t i = 0; i < subsystem_count; i++) {
+            const Counters& counters = data.counters[i];
+            file << fmt::format("    {{ \"name\": \"{}\", \"allocations\": {}, \"bytes\": {}, \"live_bytes\": {} }}{}\n", subsystem_names[i],
+                counters.allocations.load(), counters.bytes.load(), counters.live_bytes.load(), i + 1 < subsystem_count ? "," : "");
+        }
+        file << "  ],\n  \"violation_log\": [\n";
+        uint64_t logged = std::min<uint64_t>(data.violations.load(), max_violations);
+        for (uint64_t i = 0; i < logged; i++) {
+            const Violation& violation = data.violation_log[i];
+            file << fmt::format("    {{ \"region\": \"{}\", \"subsystem\": \"{}\", \"bytes\": {}, \"frame\": {} }}{}\n", violation.region_p,
+                subsystem_names[static_cast<size_t>(violation.subsystem)], violation.bytes, violation.frame, i + 1 < logged ? "," : "");
+        }
+        file << "  ]\n}\n";
+        fmt::println("Wrote allocation report to {}, {} allocations in no-alloc regions", path, data.violations.load());
+        return true;
+    }
+}
@@ -0,0 +1,353 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include <fmt/base.h>
+#include <fmt/format.h>
+#include "files.hpp"
+#include "gl_debug.hpp"
+#include "frame_arena.hpp"
+#include "alloc_tracker.hpp"
+#include "phase_timer.hpp"
+#include "profiler.hpp"
+#include "pipeline.hpp"
+#include "entities/model.hpp"
+#include "entities/texture.hpp"
+
+// compact handles into the AssetManager tables
+using ModelId = uint16_t;
+using TextureId = uint16_t;
+using PipelineId = uint16_t;
+
+// load-once cache for models, textures and shader pipelines
+// every asset is reference counted and released once its last user lets go,
+// gameplay code only ever resolves handles that were acquired during loading
+// while async loading is active, file reads, parsing and decoding run on worker threads
+// and the main thread only does the gpu uploads in pump()
+struct AssetManager {
+    enum class Type { eModel, eTexture, ePipeline };
+
+    // what the debug ui and reports show per asset
+    struct Record {
+        std::string name;
+        Type type;
+        uint32_t refs;
+        float read_ms; // file reads, parsing and decoding (worker thread when async)
+        float upload_ms; // gpu upload on the main thread
+        size_t gpu_bytes;
+        bool cached; // came from a binary cache instead of the source file
+        bool ready;
+    };
+
+    auto acquire_model(const std::string& path) -> ModelId {
+        return acquire(_models, "model:" + path, path, Type::eModel,
+            [path] { return Model::read(path, &FrameArena::for_thread()); },
+            [](Model& model, const Model::Source& source) { model.init(source); });
+    }
+    auto acquire_model(Mesh::Primitive primitive) -> ModelId {
+        std::string name = primitive_name(primitive);
+        return acquire(_models, "primitive:" + name, name, Type::eModel,
+            [] { return 0; }, // generated on the gpu side, nothing to read
+            [primitive](Model& model, int) { model.init(primitive); });
+    }
+    auto acquire_texture(const std::string& path) -> TextureId {
+        return acquire(_textures, "texture:" + path, path, Type::eTexture,
+            [path] { return Texture::decode(path.c_str()); },
+            [](Texture& texture, const Texture::Image& image) { texture.init(image); });
+    }
+    auto acquire_pipeline(const std::string& vs_path, const std::string& fs_path) -> PipelineId {
+        std::string name = vs_path + " + " + fs_path;
+        return acquire(_pipelines, "pipeline:" + name, name, Type::ePipeline,
+            [vs_path, fs_path] { return Pipeline::read(vs_path.c_str(), fs_path.c_str()); },
+            [](Pipeline& pipeline, const Pipeline::Source& source) { pipeline.init(source); });
+    }
+
+    void release_model(ModelId id) { release(_models, id); }
+    void release_texture(TextureId id) { release(_textures, id); }
+    void release_pipeline(PipelineId id) { release(_pipelines, id); }
+
+    // assets that are still loading resolve to empty objects
+    Model& model(ModelId id) { return _models[id].asset; }
+    Texture& texture(TextureId id) { return _textures[id].asset; }
+    Pipeline& pipeline(PipelineId id) { return _pipelines[id].asset; }
+
+    // load every asset listed in a manifest file, the manifest keeps one reference to each
+    // lines look like "model <path>", "texture <path>" or "pipeline <vs path> <fs path>"
+    void preload(const char* manifest_path) {
+        FileData file = Files::load(manifest_path);
+        if (!file) return;
+        std::istringstream lines{std::string(file.text())};
+        std::string line;
+        while (std::getline(lines, line)) {
+            std::istringstream words(line);
+            std::string type, path, second_path;
+            if (!(words >> type) || type[0] == '#') continue;
+            words >> path >> second_path;
+            if (type == "model") acquire_model(path);
+            else if (type == "texture") acquire_texture(path);
+            else if (type == "pipeline") acquire_pipeline(path, second_path);
+            else fmt::println("Unknown asset type in manifest: {}", type);
+        }
+    }
+
+    // start worker threads, loads from now on only queue their cpu side work
+    void begin_async(uint32_t worker_count = std::clamp(std::thread::hardware_concurrency(), 2u, 5u) - 1) {
+        _async_start = std::chrono::high_resolution_clock::now();
+        _async_start_ms = PhaseTimer::now_ms();
+        _batch_total = 0;
+        _batch_done = 0;
+        _stopping = false;
+        for (uint32_t i = 0; i < worker_count; i++) {
+            _workers.emplace_back([this] { work(); });
+        }
+    }
+    // run the gpu uploads of finished reads for at most budget_ms (at least one upload)
+    void pump(float budget_ms) {
+        AllocTracker::Scope alloc_scope(AllocTracker::Subsystem::eAssets);
+        auto start = std::chrono::high_resolution_clock::now();
+        while (true) {
+            std::function<void()> upload;
+            {
+                std::lock_guard lock(_mutex);
+                if (_completed.empty()) return;
+                upload = std::move(_completed.front());
+                _completed.pop_front();
+            }
+            upload();
+            _batch_done++;
+            auto elapsed = std::chrono::high_resolution_clock::now() - start;
+            if (std::chrono::duration<float, std::milli>(elapsed).count() >= budget_ms) return;
+        }
+    }
+    // stop the workers once everything is uploaded and print the timing report
+    void end_async() {
+        {
+            std::lock_guard lock(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (auto& worker: _workers) worker.join();
+        _workers.clear();
+        auto duration = std::chrono::high_resolution_clock::now() - _async_start;
+        PhaseTimer::record("asset loading", _async_start_ms, PhaseTimer::now_ms() - _async_start_ms, 0);
+        report(std::chrono::duration<float, std::milli>(duration).count());
+    }
+    bool loading() const { return _batch_done < _batch_total; }
+    // uploaded fraction of the current batch
+    float progress() const { return _batch_total == 0 ? 1.0f : static_cast<float>(_batch_done) / _batch_total; }
+
+    // from now on every load is reported, gameplay should only hit the cache
+    void lock() { _locked = true; }
+
+    void destroy() {
+        if (!_workers.empty()) end_async();
+        for (auto& slot: _models) if (_records[slot.record].refs > 0) slot.asset.destroy();
+        for (auto& slot: _textures) if (_records[slot.record].refs > 0) slot.asset.destroy();
+        for (auto& slot: _pipelines) if (_records[slot.record].refs > 0) slot.asset.destroy();
+        _models.clear();
+        _textures.clear();
+        _pipelines.clear();
+        _records.clear();
+        _lookup.clear();
+        _completed.clear();
+    }
+
+    // cpu side of the model table, the slots plus every model's mesh, material and texture arrays
+    auto model_cpu_bytes() const -> size_t {
+        size_t bytes = _models.capacity() * sizeof(Slot<Model>);
+        for (const auto& slot: _models) {
+            const Model& model = slot.asset;
+            bytes += model._meshes.capacity() * sizeof(Mesh) + model._materials.capacity() * sizeof(Material) + model._textures.capacity() * sizeof(Texture);
+        }
+        return bytes;
+    }
+
+    auto total_gpu_bytes() const -> size_t {
+        size_t bytes = 0;
+        for (const Record& record: _records) bytes += record.gpu_bytes;
+        return bytes;
+    }
+
+    // per asset timings, wall_ms is how long the whole batch took
+    void report(float wall_ms) const {
+        float read_ms = 0.0f, upload_ms = 0.0f;
+        fmt::println("{:>9} {:>9}  {:<5}  {}", "read ms", "upload ms", "", "asset");
+        for (const Record& record: _records) {
+            fmt::println("{:>9.2f} {:>9.2f}  {:<5}  {}", record.read_ms, record.upload_ms, record.cached ? "warm" : "cold", record.name);
+            read_ms += record.read_ms;
+            upload_ms += record.upload_ms;
+        }
+        fmt::println("{} assets loaded in {:.2f} ms ({:.2f} ms reading on workers, {:.2f} ms uploading)", _records.size(), wall_ms, read_ms, upload_ms);
+    }
+
+    std::vector<Record> _records;
+
+private:
+    template<typename T>
+    struct Slot {
+        T asset;
+        uint32_t record;
+    };
+
+    template<typename T, typename Read, typename Upload>
+    auto acquire(std::vector<Slot<T>>& slots, const std::string& key, const std::string& name, Type type, Read read, Upload upload) -> uint16_t {
+        auto it = _lookup.find(key);
+        if (it != _lookup.end()) {
+            uint16_t id = it->second;
+            Record& record = _records[slots[id].record];
+            // it was released earlier, bring it back into the same slot
+            if (record.refs == 0) load_into(slots, id, read, upload);
+            record.refs++;
+            return id;
+        }
+        uint16_t id = static_cast<uint16_t>(slots.size());
+        Slot<T>& slot = slots.emplace_back();
+        slot.record = static_cast<uint32_t>(_records.size());
+        _records.push_back({ name, type, 1, 0.0f, 0.0f, 0, false, false });
+        _lookup.emplace(key, id);
+        load_into(slots, id, read, upload);
+        return id;
+    }
+
+    // slots are addressed by index, the vectors may grow while reads are in flight
+    template<typename T, typename Read, typename Upload>
+    void load_into(std::vector<Slot<T>>& slots, uint16_t id, Read read, Upload upload) {
+        Record& record = _records[slots[id].record];
+        if (_locked) fmt::println("Asset loaded after startup: {}", record.name);
+        record.ready = false;
+        std::string name = record.name;
+        auto finish = [this, &slots, id, upload, name](auto& source, float read_ms) {
+            PhaseTimer::Scope phase("upload " + name);
+            auto start = std::chrono::high_resolution_clock::now();
+            Slot<T>& slot = slots[id];
+            slot.asset = T();
+            upload(slot.asset, source);
+            auto duration = std::chrono::high_resolution_clock::now() - start;
+            Record& record = _records[slot.record];
+            record.read_ms = read_ms;
+            record.upload_ms = std::chrono::duration<float, std::milli>(duration).count();
+            record.gpu_bytes = gpu_bytes(slot.asset);
+            record.cached = cached(slot.asset);
+            if (GlDebug::enabled()) label(slot.asset, name);
+            record.ready = true;
+        };
+
+        if (_workers.empty()) {
+            auto start = std::chrono::high_resolution_clock::now();
+            auto source = [&] {
+                PhaseTimer::Scope phase("read " + name);
+                return read();
+            }();
+            auto duration = std::chrono::high_resolution_clock::now() - start;
+            finish(source, std::chrono::duration<float, std::milli>(duration).count());
+            return;
+        }
+
+        _batch_total++;
+        {
+            std::lock_guard lock(_mutex);
+            _jobs.push_back([this, read, finish, name] {
+                auto start = std::chrono::high_resolution_clock::now();
+                // std::function needs copyable callables, so the source is shared instead of moved
+                auto source_p = [&] {
+                    PhaseTimer::Scope phase("read " + name);
+                    return std::make_shared<decltype(read())>(read());
+                }();
+                auto duration = std::chrono::high_resolution_clock::now() - start;
+                float read_ms = std::chrono::duration<float, std::milli>(duration).count();
+                std::lock_guard lock(_mutex);
+                _completed.push_back([source_p, read_ms, finish] { finish(*source_p, read_ms); });
+            });
+        }
+        _wake.notify_one();
+    }
+
+    template<typename T>
+    void release(std::vector<Slot<T>>& slots, uint16_t id) {
+        Record& record = _records[slots[id].record];
+        if (record.refs == 0) return;
+        if (--record.refs == 0) {
+            slots[id].asset.destroy();
+            record.gpu_bytes = 0;
+        }
+    }
+
+    // worker thread loop, drains the job queue before it stops
+    void work() {
+        Profiler::set_thread_name("asset worker");
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock lock(_mutex);
+                _wake.wait(lock, [this] { return _stopping || !_jobs.empty(); });
+                if (_jobs.empty()) return;
+                job = std::move(_jobs.front());
+                _jobs.pop_front();
+            }
+            Profiler::Zone zone("asset read");
+            AllocTracker::Scope alloc_scope(AllocTracker::Subsystem::eAssets);
+            job();
+            // job temporaries are gone once the job is
+            FrameArena::reset_thread();
+        }
+    }
+
+    static auto gpu_bytes(const Model& model) -> size_t { return model.gpu_bytes(); }
+    static auto gpu_bytes(const Texture& texture) -> size_t { return texture._gpu_bytes; }
+    static auto gpu_bytes(const Pipeline&) -> size_t { return 0; }
+    static bool cached(const Model& model) { return model._from_cache; }
+    static bool cached(const Texture&) { return false; }
+    static bool cached(const Pipeline&) { return false; }
+    // gl objects named after the asset, for capture tools and debug messages
+    static void label(const Model& model, const std::string& name) {
+        for (size_t i = 0; i < model._meshes.size(); i++) {
+            const Mesh& mesh = model._meshes[i];
+            std::string mesh_name = fmt::format("{} mesh {}", name, i);
+            GlDebug::label(GL_VERTEX_ARRAY, mesh._vertex_array_object, mesh_name);
+            GlDebug::label(GL_BUFFER, mesh._vertex_buffer_object, mesh_name + " vertices");
+            GlDebug::label(GL_BUFFER, mesh._element_buffer_object, mesh_name + " indices");
+        }
+        for (size_t i = 0; i < model._textures.size(); i++) {
+            GlDebug::label(GL_TEXTURE, model._textures[i]._texture, fmt::format("{} texture {}", name, i));
+        }
+    }
+    static void label(const Texture& texture, const std::string& name) { GlDebug::label(GL_TEXTURE, texture._texture, name); }
+    static void label(const Pipeline& pipeline, const std::string& name) { GlDebug::label(GL_PROGRAM, pipeline._shader_program, name); }
+
+    static auto primitive_name(Mesh::Primitive primitive) -> std::string {
+        switch (primitive) {
+            case Mesh::eCube: return "cube";
+            case Mesh::eSphere: return "sphere";
+            case Mesh::Wall: return "wall";
+        }
+        return "unknown";
+    }
+
+    std::vector<Slot<Model>> _models;
+    std::vector<Slot<Texture>> _textures;
+    std::vector<Slot<Pipeline>> _pipelines;
+    std::unordered_map<std::string, uint16_t> _lookup; // only used while loading
+    bool _locked = false;
+
+    // async loading
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _jobs; // reads, run on the workers
+    std::deque<std::function<void()>> _completed; // gpu uploads, run in pump()
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    bool _stopping = false;
+    uint32_t _batch_total = 0;
+    uint32_t _batch_done = 0;
+    std::chrono::high_resolution_clock::time_point _async_start;
+    double _async_start_ms = 0.0;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <span>
+#include "pool.hpp"
+#include "assets.hpp"
+#include "mixer.hpp"
+#include "frame_stats.hpp"
+#include "gpu_timer.hpp"
+#include "draw_stats.hpp"
+#include "alloc_tracker.hpp"
+#include "gl_resources.hpp"
+
+// numbers collected by the engine each frame for the debug window
+struct DebugStats {
+    std::array<PoolStats, 4> pools;
+    size_t model_table_bytes; // cpu side of the loaded models
+    std::array<uint32_t, 3> lod_tiers; // enemies per simulation LOD tier
+    uint32_t recycled_enemies;
+    std::span<const AssetManager::Record> assets;
+    uint32_t audio_voices; // currently mixed
+    uint32_t audio_dropped; // play requests that got no voice
+    size_t audio_bytes; // decoded samples kept in memory
+    const char* pacing_mode;
+    float frame_ms; // present to present
+    float pacing_wait_ms; // spent in the frame limiter
+    float latency_ms; // estimated input sample to display
+    const FrameStats* frame_stats_p;
+    const GpuTimer* gpu_timer_p;
+    const DrawStats::Frame* draw_stats_p; // last finished frame
+    size_t arena_frame_bytes; // frame arena use of the last frame
+    size_t arena_high_water;
+    size_t arena_capacity;
+    uint32_t arena_overflows; // allocations that did not fit and went to the heap
+    size_t worker_arena_high_water; // largest worker job
+    const AllocTracker::Data* alloc_p; // nullptr unless built with ALLOC_TRACKING
+    const GlResources::Totals* gl_resources_p;
+    bool profiling; // a profiler capture is running
+};
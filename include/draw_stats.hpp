@@ -0,0 +1,93 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// draw calls, triangles and state changes of a frame, by render pass and entity category
+// the draw and bind functions count themselves, the renderer only says which pass and category it is in
+// main thread only, like every gl call
+namespace DrawStats {
+    enum class Pass : uint8_t { eShadows, eColor, eUI, eCount };
+    enum class Category : uint8_t { eOther, eTerrain, ePlayer, eEnemies, eProjectiles, eFood, eBoss, eCount };
+    static constexpr size_t pass_count = static_cast<size_t>(Pass::eCount);
+    static constexpr size_t category_count = static_cast<size_t>(Category::eCount);
+    static constexpr std::array<const char*, pass_count> pass_names = { "shadows", "color", "ui" };
+    // other is state set for the whole pass, like programs, cameras and lights
+    static constexpr std::array<const char*, category_count> category_names = { "other", "terrain", "player", "enemies", "projectiles", "food", "boss" };
+
+    struct Counters {
+        uint32_t draw_calls;
+        uint32_t triangles;
+        uint32_t instances;
+        uint32_t program_binds;
+        uint32_t vao_binds;
+        uint32_t texture_binds;
+        uint32_t uniform_uploads;
+
+        void operator+=(const Counters& other) {
+            draw_calls += other.draw_calls;
+            triangles += other.triangles;
+            instances += other.instances;
+            program_binds += other.program_binds;
+            vao_binds += other.vao_binds;
+            texture_binds += other.texture_binds;
+            uniform_uploads += other.uniform_uploads;
+        }
+    };
+    struct Frame {
+        std::array<std::array<Counters, category_count>, pass_count> counters;
+
+        auto pass_total(Pass pass) const -> Counters {
+            Counters total = {};
+            for (const Counters& counters: this->counters[static_cast<size_t>(pass)]) total += counters;
+            return total;
+        }
+        auto category_total(Category category) const -> Counters {
+            Counters total = {};
+            for (const auto& pass: counters) total += pass[static_cast<size_t>(category)];
+            return total;
+        }
+    };
+
+    struct Data {
+        Frame current = {};
+        Frame last = {}; // the last finished frame, for display
+        Counters* counters_p = &current.counters[0][0];
+        Pass pass = Pass::eShadows;
+
+        static Data& get() {
+            static Data instance;
+            return instance;
+        }
+    };
+
+    inline auto counters() -> Counters& { return *Data::get().counters_p; }
+    inline void set_category(Category category) {
+        Data& data = Data::get();
+        data.counters_p = &data.current.counters[static_cast<size_t>(data.pass)][static_cast<size_t>(category)];
+    }
+    // also goes back to the other category
+    inline void set_pass(Pass pass) {
+        Data::get().pass = pass;
+        set_category(Category::eOther);
+    }
+
+    inline void count_draw(uint32_t triangles, uint32_t instances = 1) {
+        Counters& current = counters();
+        current.draw_calls++;
+        current.triangles += triangles * instances;
+        current.instances += instances;
+    }
+    inline void count_program_bind() { counters().program_binds++; }
+    inline void count_vao_bind() { counters().vao_binds++; }
+    inline void count_texture_bind() { counters().texture_binds++; }
+    inline void count_uniforms(uint32_t count) { counters().uniform_uploads += count; }
+
+    // keep the finished frame around for display and start counting the next one
+    inline void end_frame() {
+        Data& data = Data::get();
+        data.last = data.current;
+        data.current = {};
+        set_pass(Pass::eShadows);
+    }
+    inline auto last() -> const Frame& { return Data::get().last; }
+}
@@ -1,9 +1,9 @@
 #pragma once
 #include <array>
+#include <optional>
 #include <glbinding/gl46core/gl.h>
 using namespace gl46core;
 #include <SDL3/SDL_init.h>
-#include <SDL3/SDL_audio.h>
 #include <glm/glm.hpp>
 #include <fmt/base.h>
 #include <imgui.h>
@@ -11,6 +11,15 @@ using namespace gl46core;
 #include <imgui_impl_opengl3.h>
 #include "time.hpp"
 #include "window.hpp"
+#include "frame_pacer.hpp"
+#include "frame_stats.hpp"
+#include "gpu_timer.hpp"
+#include "draw_stats.hpp"
+#include "gl_debug.hpp"
+#include "frame_arena.hpp"
+#include "alloc_tracker.hpp"
+#include "gl_resources.hpp"
+#include "profiler.hpp"
 #include "input.hpp"
 #include "pipeline.hpp"
 #include "entities/camera.hpp"
@@ -25,31 +34,65 @@ using namespace gl46core;
 #include "entities/upgrade.hpp"
 #include "entities/food.hpp"
 #include "state.hpp"
+#include "files.hpp"
+#include "mixer.hpp"
+#include "phase_timer.hpp"
+#include "assets.hpp"
+#include "pool.hpp"
+#include "flow_field.hpp"
+#include "sim_lod.hpp"
+#include "debug_stats.hpp"
 
 struct Engine {
 
     void init() {
+        PhaseTimer::Scope phase("engine init");
+        Profiler::set_thread_name("main");
         _gameState = GameState::MENU;
         _spawn_timer = 0.0f;
+        Time::set_tick_rate(_tick_rate);
+        Files::init();
+        _frame_arena.init();
 
         _window.init(width, height, "OpenGL Renderer");
+        _pacer.init(_window._window_p, _pacing_mode, _fps_limit);
+        _gpu_timer.init();
+        GlResources::init_soak();
         _camera.set_perspective(width, height, 70);
         glm::vec3 rotation(-glm::radians(70.0f), glm::radians(180.0f), 0.0f);
         _camera._rotation = rotation;
 
-        // create pipeline for textured objects
-        _pipeline.init("../assets/shaders/default.vert", "../assets/shaders/default.frag");
-        _pipeline_shadows.init("../assets/shaders/shadows.vert", "../assets/shaders/shadows.frag");
-        _pipeline_shadows.create_framebuffer();
+        // load everything gameplay needs up front, later acquires are cache hits
+        // reads run on worker threads while the menu is shown, uploads happen in execute_frame
+        _assets.begin_async();
+        _assets.preload("manifest.txt");
 
-        // create light and its shadow map
-        Light player_light;
-        player_light.init({0.0, 0.3, 0.0}, {5.0, 5.0, 5.6}, 350);
-        _lights.push_back(player_light);
+        // create pipeline for textured objects
+        _pipeline = _assets.acquire_pipeline("shaders/default.vert", "shaders/default.frag");
+        _pipeline_shadows = _assets.acquire_pipeline("shaders/shadows.vert", "shaders/shadows.frag");
+
+        // reserve all entity storage up front, gameplay never allocates it
+        std::optional<PhaseTimer::Scope> init_phase(std::in_place, "entity storage");
+        _enemies.init(max_enemies);
+        _projectiles.init(max_projectiles);
+        _foods.init(max_foods);
+        _lights.init(max_lights);
+        _flow_field.init(_arena_half_extent, 2.0f);
+        _separation_grid.init(_arena_half_extent, _separation_radius, max_enemies);
+        _enemy_positions = std::make_unique<glm::vec2[]>(max_enemies);
+        _enemy_distances = std::make_unique<EnemyDistance[]>(max_enemies);
+
+        // create lights and their shadow maps, the boss light stays off until a boss spawns
+        // so gameplay never creates gl objects
+        init_phase.emplace("lights and terrain");
+        _lights.spawn(&_player_light)->init({0.0, 0.3, 0.0}, {5.0, 5.0, 5.6}, 350);
+        Light* boss_light_p = _lights.spawn(&_boss_light);
+        boss_light_p->init({0.0, 1.0, 0.0}, {4.1f, 4.4f, 4.6f}, 500);
+        boss_light_p->active = false;
 
         // create players
-        _player.init("../assets/models/Goldfish.obj");
-        _player._model._transform._scale = glm::vec3(0.5f);
+        _player.init(_assets.acquire_model("models/Goldfish.obj"));
+        _player._transform._scale = glm::vec3(0.5f);
         // create floor and walls
         // 0 - floor
         // 1 - top wall
@@ -72,12 +115,13 @@ struct Engine {
         _terrain[4]._transform._scale = glm::vec3(200.0f, 2.0f, 10.0f);
         _terrain[4]._transform._position = glm::vec3(0.0f, -5.0f, -100.0f);
 
-        // create initial enemies
-        setup_enemy_configs();
-
         // load models to pool
+        init_phase.emplace("enemy setup");
         load_models_to_pool();
 
+        // create initial enemies
+        setup_enemy_configs();
+
         _boss._state = Enemy::State::DEAD;
         _boss_spawned = false;
         _boss_spawn_timer = 0.0f;
@@ -86,27 +130,39 @@ struct Engine {
         SDL_SetWindowRelativeMouseMode(_window._window_p, false);
 
         // init audio
+        init_phase.emplace("audio init");
         SDL_InitSubSystem(SDL_INIT_AUDIO);
+        _sounds.init(Mixer::output_spec());
+        _mixer.init(_sounds);
 
         // init ui manager
+        init_phase.emplace("imgui init");
         _uiManager.init(_window._window_p, _window._context);
     }
     
     void destroy() {
-        for (auto& audio : active_audio_streams) {
-            SDL_DestroyAudioStream(audio.stream);
-        }
-        active_audio_streams.clear();
-        
+        // startup and load timings, set PRINT_STARTUP_TIMINGS to also get them on the console
+        const char* base_path_p = SDL_GetBasePath();
+        PhaseTimer::write_json(std::string(base_path_p ? base_path_p : "") + "startup_timings.json");
+        AllocTracker::write_report(std::string(base_path_p ? base_path_p : "") + "alloc_report.json");
+        if (std::getenv("PRINT_STARTUP_TIMINGS") != nullptr) PhaseTimer::print();
+
+        _mixer.destroy();
+        _sounds.destroy();
         SDL_QuitSubSystem(SDL_INIT_AUDIO);
 
         // free OpenGL resources
+        _gpu_timer.destroy();
         for (auto& light: _lights) light.destroy();
         for (auto& terrain: _terrain) terrain.destroy();
         _player.destroy();
         for (auto& enemy: _enemies) enemy.destroy();
-        _pipeline.destroy();
+        _assets.destroy();
+        Files::destroy();
+        // everything the engine created is gone by now, whatever is left leaked
+        GlResources::report_leaks();
         _window.destroy();
+        _frame_arena.destroy();
         
         // shut down ImGui
         _uiManager.shutdown();
@@ -140,10 +196,8 @@ struct Engine {
         _boss._state = Enemy::State::DEAD;
         _boss_spawned = false;
 
-        _lights.clear();
-        Light player_light;
-        player_light.init({0.0, 0.3, 0.0}, {5.0, 5.0, 5.6}, 350);
-        _lights.push_back(player_light);
+        // both lights are kept, the boss light turns back on with the next boss
+        _lights.get(_boss_light)->active = false;
     }
 
     auto execute_event(SDL_Event* event_p) -> SDL_AppResult {
@@ -159,9 +213,7 @@ struct Engine {
         return SDL_AppResult::SDL_APP_CONTINUE;   
     }
 
-    void execute_input() {
-        float delta_time = Time::get_delta();
-        
+    void execute_input(float delta_time) {
         if (!_showing_upgrades)
         {
             // Update camera position and rotation
@@ -174,38 +226,32 @@ struct Engine {
                 inv_view
         );
         }
-        _camera._position = _player.get_position() + offset;
-        _lights[0]._position = _player.get_position() + glm::vec3(0.0f, 1.0f, 1.0f);
-
-        // Process input
-        Input::flush();
     }
 
     void load_models_to_pool() {
-        _model_pool["shark"] = Model();
-        _model_pool["shark"].init("../assets/models/Shark.obj");
-        
-        _model_pool["koi"] = Model();
-        _model_pool["koi"].init("../assets/models/Koi.obj");
-
-        _model_pool["blob"] = Model();
-        _model_pool["blob"].init("../assets/models/Blobfish.obj");
+        _shark_model = _assets.acquire_model("models/Shark.obj");
+        _koi_model = _assets.acquire_model("models/Koi.obj");
+        _blob_model = _assets.acquire_model("models/Blobfish.obj");
+        _boss_model = _assets.acquire_model("models/Anglerfish.obj");
+        _food_model = _assets.acquire_model("models/Worm.obj");
+        _projectile_model = _assets.acquire_model(Mesh::eSphere);
     }
 
     void create_enemy(EnemyType type, const glm::vec3& position){
-        const auto& config = _enemy_configs[type];
+        const auto& config = _enemy_configs[static_cast<size_t>(type)];
     
-        _enemies.emplace_back();
-        Enemy& new_enemy = _enemies.back();
+        Enemy* enemy_p = _enemies.spawn();
+        if (enemy_p == nullptr) return; // pool exhausted
+        Enemy& new_enemy = *enemy_p;
         
-        // Copy models
-        new_enemy._model = _model_pool[config.model_key];
-        
-        // Configure enemy
+        // Configure enemy (model is shared through its id)
         new_enemy.init_from_config(config, difficulty);
-        new_enemy._model._transform._scale = glm::vec3(0.5f);
+        new_enemy._transform._scale = glm::vec3(0.5f);
         new_enemy.set_position(position);
+        new_enemy._transform.snapshot();
         new_enemy._state = Enemy::State::ALIVE;
+        new_enemy._lod_delta = 0.0f;
+        new_enemy._lod_phase = _enemy_spawn_count++;
     }
 
     void spawn_boss () {
@@ -226,9 +272,9 @@ struct Engine {
         spawn_pos.x = glm::clamp(spawn_pos.x, min_x, max_x);
         spawn_pos.z = glm::clamp(spawn_pos.z, min_z, max_z);
 
-        play_audio("../assets/audio/jump.wav");
+        _mixer.play(SoundId::eJump);
         _boss.init_boss(
-            "../assets/models/Anglerfish.obj",
+            _boss_model,
             glm::vec3(spawn_pos.x, 0.0f, spawn_pos.z),
             1.5f + (0.2f * difficulty), 
             80.0f + (20.0f * difficulty),
@@ -237,13 +283,15 @@ struct Engine {
 
         _boss._state = Enemy::State::ALIVE;
         _boss_spawned = true;
-        _lights.emplace_back().init({0.0, 1.0, 0.0}, {4.1f, 4.4f, 4.6f}, 500);
+        _lights.get(_boss_light)->active = true;
 
     }
 
     void boss_slained() {
-        _lights[1]._position = glm::vec3(120.0f, 120.0f, 120.0f);
-        play_audio("../assets/audio/big_blob.wav");
+        if (Light* light_p = _lights.get(_boss_light)) {
+            light_p->_position = glm::vec3(120.0f, 120.0f, 120.0f);
+        }
+        _mixer.play(SoundId::eBigBlob);
         _boss.die();
         _boss_spawned = false;
     }
@@ -261,13 +309,21 @@ struct Engine {
         static std::random_device rd;
         static std::mt19937 rng(rd());
         // Rarity syste
-        std::vector<float> weights;
+        // the weights only live for this call, so they come from the frame arena
+        std::pmr::vector<float> weights(&_frame_arena);
+        weights.reserve(upgrades.size());
+        float total_weight = 0.0f;
         for(const auto& upgrade : upgrades) {
             weights.push_back(get_rarity_weight(upgrade.rarity));
+            total_weight += weights.back();
         }
-                
-        std::discrete_distribution<> dist(weights.begin(), weights.end());
-        return upgrades[dist(rng)];
+        // walk the cumulative weights, discrete_distribution would copy them to the heap
+        float pick = std::uniform_real_distribution<float>(0.0f, total_weight)(rng);
+        for (size_t i = 0; i < weights.size(); i++) {
+            pick -= weights[i];
+            if (pick < 0.0f) return upgrades[i];
+        }
+        return upgrades.back();
     }
 
     void generate_upgrades(){
@@ -288,12 +344,12 @@ struct Engine {
         for(int i = 0; i < 3; ++i) {
             _current_upgrades.push_back(select_random_upgrade(all_upgrades));
         }
-        play_audio("../assets/audio/lvlup.wav");
+        _mixer.play(SoundId::eLevelUp);
     }
 
     void setup_enemy_configs() {
-        _enemy_configs[EnemyType::SHARK] = {
-            "shark",    // model_key
+        _enemy_configs[static_cast<size_t>(EnemyType::SHARK)] = {
+            _shark_model, // model
             glm::vec3(0.0f),       // center_offset    
             1.5f,       // movement speed
             5.0f,      // max_hp
@@ -301,8 +357,8 @@ struct Engine {
             0.5f       // radius
         };
         
-        _enemy_configs[EnemyType::KOI] = {
-            "koi",
+        _enemy_configs[static_cast<size_t>(EnemyType::KOI)] = {
+            _koi_model,
             glm::vec3(0.0f),
             2.0f,
             1.0f,
@@ -310,8 +366,8 @@ struct Engine {
             0.5f
         };
 
-        _enemy_configs[EnemyType::BLOB] = {
-            "blob",
+        _enemy_configs[static_cast<size_t>(EnemyType::BLOB)] = {
+            _blob_model,
             glm::vec3(0.0f),
             1.2f,
             11.0f,
@@ -321,6 +377,7 @@ struct Engine {
     }
 
     void update_spawning(float delta_time) {
+        Profiler::Zone zone("spawning");
         _spawn_timer += delta_time;
         
         if(_spawn_timer >= _spawn_time) {
@@ -388,7 +445,7 @@ struct Engine {
                                       enemy_pos, enemy_radius)) {
                 // Both die
                 _player.take_damage(enemy._damage);
-                play_audio("../assets/audio/contact.wav");
+                _mixer.play(SoundId::eContact);
                 enemy.die();
             }
         }
@@ -400,7 +457,7 @@ struct Engine {
                 _player.take_damage(_boss._damage);
                 // teleport boss nearby
                 _boss.teleport_near_player(_player.get_position());
-                play_audio("../assets/audio/contact.wav");
+                _mixer.play(SoundId::eContact);
             }
         }
 
@@ -419,7 +476,7 @@ struct Engine {
                     if (_boss._hp <= 0) {
                         boss_slained();
                     }                
-                    play_audio("../assets/audio/hit.wav");
+                    _mixer.play(SoundId::eHit);
                     projectile._piercing -= 1;
                 }
             } 
@@ -435,16 +492,18 @@ struct Engine {
                 {
                     // Apply damage to enemy
                     enemy.take_damage(projectile.get_damage(), _player);
-                    play_audio("../assets/audio/hit.wav");
+                    _mixer.play(SoundId::eHit);
                     if (enemy._state == Enemy::State::DEAD)
                     {
                         float rand = glm::linearRand(0.0f,1.0f);
-                        if (rand < 0.05f)
+                        Food* food_p = rand < 0.05f ? _foods.spawn() : nullptr;
+                        if (food_p != nullptr)
                         {
-                            _foods.emplace_back().init("../assets/models/Worm.obj");
-                            Food& new_food = _foods.back();
-                            new_food._model._transform._scale = glm::vec3(1.0f);                      
+                            Food& new_food = *food_p;
+                            new_food.init(_food_model);
+                            new_food._transform._scale = glm::vec3(1.0f);                      
                             new_food.set_position(enemy.get_position());
+                            new_food._transform.snapshot();
                             new_food._state = Food::State::ALIVE;
                         }
                     }
@@ -459,58 +518,27 @@ struct Engine {
             if (check_sphere_collision(player_pos, player_radius, food.get_position(), food._radius))
             {
                 _player._hp = glm::clamp(_player._hp + food.heal, 0, _player._max_hp);
-                play_audio("../assets/audio/eat.wav");
+                _mixer.play(SoundId::eEat);
                 food._state = Food::State::DEAD;
             }
         } 
     }
 
-    void play_audio(const char* path) {
-        SDL_AudioSpec file_spec;
-        Uint8* file_buffer;
-        Uint32 file_length;
-    
-        if (!SDL_LoadWAV(path, &file_spec, &file_buffer, &file_length)) {
-            return;
-        }
-    
-        SDL_AudioStream* stream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, nullptr, nullptr, nullptr);
-        if (!stream) {
-            SDL_free(file_buffer);
-            return;
-        }
-    
-        SDL_AudioSpec device_spec;
-        SDL_GetAudioDeviceFormat(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &device_spec, nullptr);
-        if (SDL_SetAudioStreamFormat(stream, &file_spec, &device_spec) < 0) {
-            SDL_free(file_buffer);
-            SDL_DestroyAudioStream(stream);
-            return;
-        }
-    
-        if (SDL_PutAudioStreamData(stream, file_buffer, file_length) < 0) {
-        }
-        SDL_free(file_buffer);
-    
-        SDL_ResumeAudioStreamDevice(stream);
-    
-        active_audio_streams.push_back({stream, SDL_GetTicks()});
-    }
-
     void update_bullets(float delta_time){
+        Profiler::Zone zone("bullets");
         float attack_cooldown = 1.0f / _player._attack_speed;
         time_since_last_shot += delta_time;
 
         if (time_since_last_shot >= attack_cooldown)
         {    
             time_since_last_shot = 0;
-            _projectiles.emplace_back();
-            Projectile& new_projectile = _projectiles.back();
-            
-            glm::vec3 direction = glm::normalize(_player.get_mouse_world_position() - _player.get_position());
+            Projectile* projectile_p = _projectiles.spawn();
+            if (projectile_p != nullptr) {
+                glm::vec3 direction = glm::normalize(_player.get_mouse_world_position() - _player.get_position());
 
-            new_projectile.init(_player.get_position(), direction, _player._bullet_speed, _player._damage, _player._piercing_strength);
-            play_audio("../assets/audio/shot.wav");
+                projectile_p->init(_projectile_model, _player.get_position(), direction, _player._bullet_speed, _player._damage, _player._piercing_strength);
+                _mixer.play(SoundId::eShot);
+            }
         }
 
         // move all bullets
@@ -525,16 +553,17 @@ struct Engine {
     }
 
     void update_boss(float delta_time) {
+        Profiler::Zone zone("boss");
         if (_boss._state == Enemy::State::ALIVE && _boss_spawned) {
             _boss.update(delta_time, _player);
             
-            if (_lights.size() >= 2) { // Stop crashing by lights vector
+            if (Light* light_p = _lights.get(_boss_light)) {
                 glm::vec3 boss_position = _boss.get_position();
-                float angle = _boss._model._transform._rotation.y;
+                float angle = _boss._transform._rotation.y;
                 glm::vec3 forward = glm::vec3(glm::sin(angle), 0.0f, glm::cos(angle));
                 glm::vec3 light_offset = forward * 3.f + glm::vec3(0.0f, 1.5f, 0.0f);
                 
-                _lights[1]._position = boss_position + light_offset;
+                light_p->_position = boss_position + light_offset;
             }
         } else {
             _boss_spawn_timer += delta_time;
@@ -545,15 +574,75 @@ struct Engine {
         }
     }
 
-    void update_game(){
-        float delta_time;
-        Time::update();
-        delta_time = Time::get_delta();
-        if (_showing_upgrades) {
-            delta_time = 0;
+    // despawn the enemies farthest from the player once there are more than the budget allows
+    void recycle_far_enemies() {
+        if (_enemy_budget == 0 || _enemies.size() <= _enemy_budget) return;
+
+        const glm::vec3 player_pos = _player.get_position();
+        uint32_t count = 0;
+        for (auto& enemy : _enemies) {
+            const glm::vec3 to_player = enemy.get_position() - player_pos;
+            _enemy_distances[count++] = { glm::dot(to_player, to_player), &enemy };
+        }
+        // move the closest ones to the front, everything after the budget goes
+        std::nth_element(_enemy_distances.get(), _enemy_distances.get() + _enemy_budget, _enemy_distances.get() + count,
+            [](const EnemyDistance& a, const EnemyDistance& b) { return a.distance_sq < b.distance_sq; });
+        for (uint32_t i = _enemy_budget; i < count; i++) {
+            _enemy_distances[i].enemy_p->die();
+            _recycled_enemies++;
+        }
+    }
+
+    // steer the swarm along the flow field while pushing neighbors apart
+    void update_enemies(float delta_time) {
+        Profiler::Zone zone("enemy updates");
+        recycle_far_enemies();
+        _flow_field.update(_player.get_position());
+        _sim_lod.begin_tick(_camera._projection_mat * _camera.get_view_matrix(), _player.get_position());
+
+        // bucket enemy positions so each one only looks at its neighbor cells
+        uint32_t count = 0;
+        for (auto& enemy : _enemies) {
+            const glm::vec3 position = enemy.get_position();
+            _enemy_positions[count++] = glm::vec2(position.x, position.z);
+        }
+        _separation_grid.build(_enemy_positions.get(), count);
+
+        uint32_t i = 0;
+        for (auto& enemy : _enemies) {
+            const glm::vec2 position = _enemy_positions[i++];
+            // distant enemies only move every few ticks, but cover the same distance
+            enemy._lod_delta += delta_time;
+            SimLod::Tier tier = _sim_lod.classify(enemy.get_position());
+            if (!_sim_lod.due(tier, enemy._lod_phase)) continue;
+
+            glm::vec2 direction = _flow_field.sample(position);
+            direction += _separation_grid.separation(position, _separation_radius) * _separation_weight;
+            // never move faster than the enemy's own speed
+            float length_sq = glm::dot(direction, direction);
+            if (length_sq > 1.0f) direction = direction * (1.0f / std::sqrt(length_sq));
+            enemy.steer(enemy._lod_delta, direction);
+            enemy._lod_delta = 0.0f;
         }
+    }
+
+    // store where every moving entity was before this tick moves it
+    void snapshot_transforms() {
+        _player._transform.snapshot();
+        _boss._transform.snapshot();
+        for (auto& enemy : _enemies) enemy._transform.snapshot();
+        for (auto& projectile : _projectiles) projectile._transform.snapshot();
+        for (auto& food : _foods) food._transform.snapshot();
+    }
+
+    // advance the game by one fixed simulation tick
+    void update_simulation(float delta_time) {
+        FrameStats::Scope frame_phase(_frame_stats, FrameStats::Phase::eSimulation);
+        AllocTracker::Scope alloc_scope(AllocTracker::Subsystem::eSim);
+        snapshot_transforms();
+
         // update input
-        execute_input();
+        execute_input(delta_time);
         
         _game_timer += delta_time;
         update_spawning(delta_time);
@@ -566,131 +655,256 @@ struct Engine {
             _difficulty_timer = 0;
         }
 
-        // Update enemies
-        for (auto& enemy : _enemies) {
-            enemy.update(delta_time, _player);
-        }
+        update_enemies(delta_time);
 
         update_bullets(delta_time);
-        check_collisions();
+        {
+            FrameStats::Scope frame_phase(_frame_stats, FrameStats::Phase::eCollisions);
+            check_collisions();
+        }
         
-        // Eliminate all inactive objects
-        std::erase_if(_enemies, [](const Enemy& enemy) {
+        // Return all inactive objects to their pools
+        _enemies.despawn_if([](const Enemy& enemy) {
             return enemy._state == Enemy::State::DEAD;
         });
 
-        std::erase_if(_projectiles, [](const Projectile& projectile) {
+        _projectiles.despawn_if([](const Projectile& projectile) {
             return !projectile.is_active();
         });
 
-        std::erase_if(_foods, [](const Food& food) {
+        _foods.despawn_if([](const Food& food) {
             return food._state == Food::State::DEAD;
         });
+    }
 
-        std::erase_if(_lights, [](const Light& light) {
-            return light.active == false;
-        });
+    // draw the world, alpha blends between the last two simulation ticks
+    void render_game(float alpha) {
+        AllocTracker::Scope alloc_scope(AllocTracker::Subsystem::eRender);
+        // follow the interpolated player so the camera moves smoothly between ticks
+        const glm::vec3 player_pos = _player.get_render_position(alpha);
+        _camera._position = player_pos + offset;
+        _lights.get(_player_light)->_position = player_pos + glm::vec3(0.0f, 1.0f, 1.0f);
 
         // draw shadows
         if (_shadows_dirty) {
+            FrameStats::Scope frame_phase(_frame_stats, FrameStats::Phase::eShadows);
+            DrawStats::set_pass(DrawStats::Pass::eShadows);
+            GlDebug::Group debug_group("shadows");
             // do this for each light
+            int light_i = 0;
             for (auto& light: _lights) {
-                _pipeline_shadows.bind();
+                _assets.pipeline(_pipeline_shadows).bind();
                 glUniform1f(0, Time::get_total());
                 glViewport(0, 0, light._shadow_width, light._shadow_height);
                 // render into each cubemap face
                 for (int face = 0; face < 6; face++) {
+                    GpuTimer::Scope gpu_pass(_gpu_timer, FrameStats::Phase::eShadows, light_i, face);
                     // bind the target shadow map and clear it
-                    light.bind_write(_pipeline_shadows._framebuffer, face);
+                    light.bind_write(_assets.pipeline(_pipeline_shadows)._framebuffer, face);
                     glClear(GL_DEPTH_BUFFER_BIT);
                     // draw the stuff
+                    DrawStats::set_category(DrawStats::Category::eTerrain);
                     for (auto& model: _terrain) model.draw(false);
-                    _player.draw(false);
-                    for (auto& enemy: _enemies) enemy.draw(false);
+                    DrawStats::set_category(DrawStats::Category::ePlayer);
+                    _player.draw(_assets.model(_player._model_id), false, alpha);
+                    DrawStats::set_category(DrawStats::Category::eEnemies);
+                    for (auto& enemy: _enemies) enemy.draw(_assets.model(enemy._model_id), false, alpha);
+                    DrawStats::set_category(DrawStats::Category::eBoss);
                     if (_boss_spawned && _boss._state == Enemy::State::ALIVE) {
-                        _boss.draw(false);
+                        _boss.draw(_assets.model(_boss._model_id), false, alpha);
                     }
-                    for (auto& food: _foods) food.draw(false);
+                    DrawStats::set_category(DrawStats::Category::eFood);
+                    for (auto& food: _foods) food.draw(_assets.model(food._model_id), false, alpha);
+                    DrawStats::set_category(DrawStats::Category::eOther);
                 }
+                light_i++;
             }
             _shadows_dirty = false;
         }
 
         // draw color
         {
+            FrameStats::Scope frame_phase(_frame_stats, FrameStats::Phase::eColor);
+            GpuTimer::Scope gpu_pass(_gpu_timer, FrameStats::Phase::eColor);
+            DrawStats::set_pass(DrawStats::Pass::eColor);
+            GlDebug::Group debug_group("color");
             // bind pipeline
-            _pipeline.bind();
+            _assets.pipeline(_pipeline).bind();
             glUniform1f(0, 0);
             glViewport(0, 0, 1280, 720);
             // clear screen before drawing
             glClearColor(0.08627451f, 0.19607843f, 0.35686275f, 1.0);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
             // bind lights and their shadow maps
-            for (int i = 0; i < _lights.size(); i++) {
-                _lights[i].bind_read(i + 1, i * 3);
+            uint32_t light_i = 0;
+            for (auto& light: _lights) {
+                light.bind_read(light_i + 1, light_i * 3);
+                light_i++;
             }
+            DrawStats::set_category(DrawStats::Category::eTerrain);
             for (auto& model: _terrain) model.draw(false);
+            DrawStats::set_category(DrawStats::Category::eOther);
             // Send time to move the enemies in a wave-like motion
             glUniform1f(0, Time::get_total());
             _camera.bind();
             // draw the stuff
-            _player.draw(false);
-            for (auto& enemy: _enemies) enemy.draw(false);
-            for (auto& food: _foods) food.draw(false);
+            DrawStats::set_category(DrawStats::Category::ePlayer);
+            _player.draw(_assets.model(_player._model_id), false, alpha);
+            DrawStats::set_category(DrawStats::Category::eEnemies);
+            for (auto& enemy: _enemies) enemy.draw(_assets.model(enemy._model_id), false, alpha);
+            DrawStats::set_category(DrawStats::Category::eFood);
+            for (auto& food: _foods) food.draw(_assets.model(food._model_id), false, alpha);
+            DrawStats::set_category(DrawStats::Category::eProjectiles);
             for (auto& projectile : _projectiles) {
-                projectile.draw(false);
+                projectile.draw(_assets.model(projectile._model_id), false, alpha);
             }
+            DrawStats::set_category(DrawStats::Category::eBoss);
             if (_boss_spawned && _boss._state == Enemy::State::ALIVE)
             {
-                _boss.draw(false);
+                _boss.draw(_assets.model(_boss._model_id), false, alpha);
             }
         }
-        
+    }
+
+    void update_game(){
+        Time::update();
+        // the simulation is frozen while the upgrade window is open
+        if (!_showing_upgrades) {
+            Time::accumulate(Time::get_delta());
+        }
+        // steady state gameplay must not touch the heap, allocations in here are reported
+        {
+            AllocTracker::NoAlloc no_alloc("simulation");
+            // run as many fixed ticks as the elapsed time covers, stop early on level up
+            while (!_player.showLevelUpWindow() && Time::consume_tick()) {
+                update_simulation(static_cast<float>(Time::get_fixed_delta()));
+            }
+        }
+        {
+            AllocTracker::NoAlloc no_alloc("render");
+            render_game(static_cast<float>(Time::get_alpha()));
+        }
+
         bool level_up_triggered = _player.showLevelUpWindow();
         if (!_showing_upgrades && level_up_triggered) {
             generate_upgrades();
             _showing_upgrades = true;
         }
-        _showing_upgrades = _uiManager.render(_player, width, height, _showing_upgrades, _current_upgrades, _game_timer);
-
-        static Uint64 last_cleanup = 0;
-        Uint64 now = SDL_GetTicks();
-        if (now - last_cleanup > 1000) {
-            auto it = active_audio_streams.begin();
-            while (it != active_audio_streams.end()) {
-                // Verify if auidio stream is still playing
-                if (SDL_GetAudioStreamQueued(it->stream) <= 0) {
-                    SDL_DestroyAudioStream(it->stream);
-                    it = active_audio_streams.erase(it);
-                } else {
-                    ++it;
-                }
-            }
-            last_cleanup = now;
+        update_debug_stats();
+        {
+            FrameStats::Scope frame_phase(_frame_stats, FrameStats::Phase::eUI);
+            GpuTimer::Scope gpu_pass(_gpu_timer, FrameStats::Phase::eUI);
+            GlDebug::Group debug_group("ui");
+            _showing_upgrades = _uiManager.render(_player, width, height, _showing_upgrades, _current_upgrades, _game_timer, _debug_stats);
+        }
+        if (_uiManager._export_frame_times) {
+            _uiManager._export_frame_times = false;
+            export_frame_times();
+        }
+        if (_uiManager._toggle_profiler) {
+            _uiManager._toggle_profiler = false;
+            toggle_profiler();
+        }
+    }
+
+    void update_debug_stats() {
+        _debug_stats.pools = {
+            _enemies.stats("enemies"),
+            _projectiles.stats("projectiles"),
+            _foods.stats("foods"),
+            _lights.stats("lights"),
+        };
+        _debug_stats.model_table_bytes = _assets.model_cpu_bytes();
+        _debug_stats.lod_tiers = _sim_lod._tier_counts;
+        _debug_stats.assets = _assets._records;
+        _debug_stats.recycled_enemies = _recycled_enemies;
+        _debug_stats.audio_voices = _mixer.active_voices();
+        _debug_stats.audio_dropped = _mixer.dropped();
+        _debug_stats.audio_bytes = _sounds.resident_bytes();
+        _debug_stats.pacing_mode = FramePacer::mode_name(_pacer._mode);
+        _debug_stats.frame_ms = _pacer._frame_ms;
+        _debug_stats.pacing_wait_ms = _pacer._wait_ms;
+        _debug_stats.latency_ms = _pacer._latency_ms;
+        _frame_stats.summarize();
+        _debug_stats.frame_stats_p = &_frame_stats;
+        _debug_stats.gpu_timer_p = &_gpu_timer;
+        _debug_stats.draw_stats_p = &DrawStats::last();
+        _debug_stats.arena_frame_bytes = _frame_arena.last_frame_bytes();
+        _debug_stats.arena_high_water = _frame_arena.high_water();
+        _debug_stats.arena_capacity = _frame_arena.capacity();
+        _debug_stats.arena_overflows = _frame_arena.overflow_count();
+        _debug_stats.worker_arena_high_water = FrameArena::thread_high_water().load(std::memory_order_relaxed);
+        _debug_stats.alloc_p = AllocTracker::enabled ? &AllocTracker::Data::get() : nullptr;
+        _debug_stats.gl_resources_p = &GlResources::totals();
+        _debug_stats.profiling = Profiler::capturing();
+    }
+
+    // start a capture, or stop the running one and save it next to the executable
+    void toggle_profiler() {
+        if (!Profiler::capturing()) {
+            Profiler::start();
+            return;
+        }
+        Profiler::stop();
+        const char* base_path_p = SDL_GetBasePath();
+        Profiler::write_trace(std::string(base_path_p ? base_path_p : "") + "profile_trace.json");
+    }
+
+    // the recorded frame times next to the executable, as csv and json
+    void export_frame_times() {
+        const char* base_path_p = SDL_GetBasePath();
+        std::string base_path = base_path_p ? base_path_p : "";
+        if (_frame_stats.write_csv(base_path + "frame_times.csv") && _frame_stats.write_json(base_path + "frame_times.json")) {
+            fmt::println("Wrote {} frame times to {}frame_times.csv/.json", _frame_stats.count(), base_path);
         }
     }
 
     void check_game_over(){
         if (_game_timer >= 600){
-            play_audio("../assets/audio/win.wav");
+            _mixer.play(SoundId::eWin);
             _gameState = GameState::WIN;
         }
         if (_player._hp <= 0){
-            play_audio("../assets/audio/game_over.wav");
+            _mixer.play(SoundId::eGameOver);
             _gameState = GameState::GAME_OVER;
         } 
     }
 
+    // everything from the manifest is on the gpu
+    void on_assets_loaded() {
+        _assets.end_async();
+        {
+            PhaseTimer::Scope phase("shadow framebuffer");
+            _assets.pipeline(_pipeline_shadows).create_framebuffer();
+        }
+        _assets_ready = true;
+        // anything loaded after this point is reported as a hitch
+        _assets.lock();
+    }
+
     void execute_frame() {
+        _pacer.wait();
+        Profiler::Zone zone("frame");
+        // nothing allocated from the arena outlives a frame
+        _frame_arena.reset();
+        // reads back the gpu times of a frame from frames_in_flight frames ago
+        _gpu_timer.begin_frame(_frame_stats.frame_number(), _frame_stats);
+        _frame_stats.add(FrameStats::Phase::eInput, _pacer._input_ms);
         switch (_gameState) {
             case GameState::MENU:
-                _uiManager.render_main_menu(_gameState, width, height);
+                if (!_assets_ready) {
+                    _assets.pump(_upload_budget_ms);
+                    if (!_assets.loading()) on_assets_loaded();
+                }
+                _uiManager.render_main_menu(_gameState, width, height, _assets.progress());
                 break;
-            case GameState::RESET:
+            case GameState::RESET: {
+                PhaseTimer::Scope phase("reset");
                 reset();
                 Time::init();
                 _gameState = GameState::PLAYING;
                 break;
+            }
             case GameState::PLAYING:
                 update_game();
                 check_game_over();
@@ -708,29 +922,74 @@ struct Engine {
                 SDL_PushEvent(&quit_event);
                 return;                
         }
-        SDL_GL_SwapWindow(_window._window_p);
+        {
+            FrameStats::Scope frame_phase(_frame_stats, FrameStats::Phase::eSwap);
+            _pacer.present();
+        }
+        _frame_stats.end_frame(_pacer._frame_ms);
+        DrawStats::end_frame();
+        AllocTracker::end_frame();
+        GlResources::update_soak();
         Input::flush();
     }
 
     GameState _gameState;
     Window _window;
     Camera _camera;
-    Pipeline _pipeline;
-    Pipeline _pipeline_shadows;
-    std::vector<Light> _lights;
+    AssetManager _assets;
+    bool _assets_ready = false;
+    float _upload_budget_ms = 8.0f; // gpu upload time per menu frame while loading
+    PipelineId _pipeline;
+    PipelineId _pipeline_shadows;
+    Pool<Light> _lights;
+    PoolHandle _player_light;
+    PoolHandle _boss_light;
     std::vector<Model> _terrain;
     Player _player;
     Boss _boss;
     Model _floor;
-    std::vector<Enemy> _enemies;
-    std::vector<Projectile> _projectiles;
-    std::vector<Food> _foods; 
+    Pool<Enemy> _enemies;
+    Pool<Projectile> _projectiles;
+    Pool<Food> _foods; 
     UIManager _uiManager;
+    DebugStats _debug_stats;
+    FlowField _flow_field;
+    SpatialGrid _separation_grid;
+    std::unique_ptr<glm::vec2[]> _enemy_positions; // scratch, filled every tick
+    const float _arena_half_extent = 100.0f;
+    const float _separation_radius = 1.0f;
+    const float _separation_weight = 0.6f;
+    SimLod _sim_lod;
+    uint32_t _enemy_spawn_count = 0; // staggers enemies across LOD ticks
+    uint32_t _enemy_budget = 0; // max live enemies before the farthest get recycled, 0 disables the cap
+    uint32_t _recycled_enemies = 0;
+    struct EnemyDistance {
+        float distance_sq;
+        Enemy* enemy_p;
+    };
+    std::unique_ptr<EnemyDistance[]> _enemy_distances; // scratch for recycling
     //Enemy _enemy;
     glm::vec3 offset = glm::vec3(-0.5f, 19.0f, -7.0f);
     
-    std::unordered_map<std::string, Model> _model_pool;
-    std::unordered_map<EnemyType, EnemyConfig> _enemy_configs;
+    // shared models, entities refer to them by id
+    ModelId _shark_model, _koi_model, _blob_model, _boss_model, _food_model, _projectile_model;
+    std::array<EnemyConfig, static_cast<size_t>(EnemyType::COUNT)> _enemy_configs;
+
+    // simulation ticks per second, independent of the render rate
+    float _tick_rate = 60.0f;
+    // presentation, see FramePacer for the environment overrides
+    FramePacer _pacer;
+    FrameStats _frame_stats;
+    GpuTimer _gpu_timer;
+    FrameArena _frame_arena; // per-frame temporaries
+    FramePacer::Mode _pacing_mode = FramePacer::Mode::eVsync;
+    double _fps_limit = 0.0; // 0 for no limiter
+
+    // pool capacities
+    static constexpr uint32_t max_enemies = 32768;
+    static constexpr uint32_t max_projectiles = 512;
+    static constexpr uint32_t max_foods = 256;
+    static constexpr uint32_t max_lights = 2; // LIGHT_COUNT in default.frag
 
     // game increase difficulty
     float _spawn_timer;
@@ -753,21 +1012,8 @@ struct Engine {
     int height = 720;
 
     // audio
-    struct AudioFile {
-        void init() {}
-        void destroy() {}
-        SDL_AudioSpec spec;
-        Uint8* buffer;
-        Uint32 buffer_size;
-    };
-    AudioFile audio_file;
-    SDL_AudioStream* audio_stream;
-
-    struct ActiveAudio {
-        SDL_AudioStream* stream;
-        Uint64 start_time;
-    };
-    std::vector<ActiveAudio> active_audio_streams;
+    SoundBank _sounds;
+    Mixer _mixer;
 
 
 };
@@ -4,14 +4,15 @@
 #include <glm/gtc/constants.hpp>
 #include <string>
 #include <cmath>
-#include "entities/model.hpp"
+#include "assets.hpp"
 #include "entities/player.hpp"
 
 class Projectile {
 public:
     Projectile() = default;
 
-    void init(const glm::vec3& position, const glm::vec3& direction, float speed, float damage, int piercing) {
+    void init(ModelId model, const glm::vec3& position, const glm::vec3& direction, float speed, float damage, int piercing) {
+        _model_id = model;
         _position = position;
         _direction = glm::normalize(direction);
         _speed = speed;
@@ -21,9 +22,9 @@ public:
 
         _lifespan = 2.0f;
 
-        _model.init(Mesh::eSphere);                 
-        _model._transform._scale = glm::vec3(0.2f); 
-        _model._transform._position = _position;    
+        _transform._scale = glm::vec3(0.2f); 
+        _transform._position = _position;    
+        _transform.snapshot();
         _radius = 0.2f;
     }
 
@@ -41,11 +42,12 @@ public:
         if (!_active) return;
 
         _position += _direction * _speed * deltaTime;
-        _model._transform._position = _position;
+        _transform._position = _position;
     }
 
-    void draw(bool bind_material = false) {
-        _model.draw(bind_material);
+    // the model is owned by the AssetManager
+    void draw(Model& model, bool bind_material = false, float alpha = 1.0f) {
+        model.draw(_transform, bind_material, alpha);
     }
 
     bool is_active() const { return _active; }
@@ -57,7 +59,8 @@ public:
 
     float _damage;
     int _piercing;
-    Model _model;
+    ModelId _model_id = 0;
+    Transform _transform;
 
 private:
 
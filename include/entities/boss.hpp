@@ -8,15 +8,16 @@
 class Boss : public Enemy {
 public:
     Boss() = default;
-    void init_boss(const std::string& model_path, 
+    void init_boss(ModelId model, 
                    const glm::vec3& spawn_pos,
                    float speed,
                    float maxHp,
                    float dmg,
                    float radius) 
         {
-            _model.init(model_path);
+            _model_id = model;
             set_position(spawn_pos);
+            _transform.snapshot();
             _move_speed = speed;
             max_hp      = maxHp;
             _hp         = maxHp;
@@ -26,7 +27,7 @@ public:
 
     void update(float delta_time, Player& player) override {
         Enemy::update(delta_time, player);
-        _move_speed = _move_speed + 0.003f;
+        _move_speed = _move_speed + _speed_ramp * delta_time;
     }
 
     void die() override {
@@ -41,6 +42,7 @@ public:
         float distance_z = dis(gen);
         glm::vec3 new_pos = player_pos + glm::vec3(distance_x, 0.0f, distance_z);
         set_position(new_pos);
+        _transform.snapshot(); // no interpolation across the jump
         _move_speed = 1.5f;
     }
     float base_xp = 20.0f;
@@ -4,6 +4,7 @@ using namespace gl46core;
 #include <glm/glm.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "draw_stats.hpp"
 
 struct Camera {
     void set_perspective(float width, float height, float fov) {
@@ -32,6 +33,7 @@ struct Camera {
         glUniformMatrix4fv(9, 1, false, glm::value_ptr(view_mat));
         glUniformMatrix4fv(13, 1, false, glm::value_ptr(_projection_mat));
         glUniform3f(17, _position.x, _position.y, _position.z);
+        DrawStats::count_uniforms(3);
     }
 
     glm::mat4x4 _projection_mat;
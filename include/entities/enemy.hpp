@@ -6,17 +6,18 @@
 #include <glm/gtc/constants.hpp>
 #include <string>
 #include <cmath>
-#include "entities/model.hpp"
+#include "assets.hpp"
 #include "entities/player.hpp"
 
 enum class EnemyType {
     SHARK, // basic
     KOI,  // speedy
-    BLOB // tank 
+    BLOB, // tank 
+    COUNT
 };
 
 struct EnemyConfig {
-    std::string model_key;
+    ModelId model;
     glm::vec3 center_offset;
     float move_speed;
     float max_hp;
@@ -31,13 +32,8 @@ struct Enemy {
         DEAD
     };
 
-    void init(const std::string& model_path, const glm::vec3& center_offset = glm::vec3(0.0f)) {
-        _model.init(model_path);
-        _center_offset = center_offset;
-        _model._transform._scale = glm::vec3(0.5f);
-    }
-
     void init_from_config(const EnemyConfig& config, int difficulty){
+        _model_id = config.model;
         _move_speed = config.move_speed * (1 + (0.2 * (difficulty-1)));
         max_hp = config.max_hp + (4 * (difficulty-1));
         _hp = max_hp;
@@ -57,7 +53,22 @@ struct Enemy {
         update_movement(delta_time, player_pos);
         update_rotation(player_pos);
 
-        _move_speed = _move_speed + 0.003f; // Increase speed over time
+        _move_speed = _move_speed + _speed_ramp * delta_time; // Increase speed over time
+    }
+
+    // move along a precomputed direction (xz) instead of chasing the player directly
+    void steer(float delta_time, const glm::vec2& direction) {
+        if (_state == State::DEAD) return;
+
+        glm::vec3 new_position = get_position() + glm::vec3(direction.x, 0.0f, direction.y) * _move_speed * delta_time;
+        set_position(new_position);
+        if (direction.x != 0.0f || direction.y != 0.0f) {
+            float angle = std::atan2(direction.x, direction.y);
+            if (angle < 0) angle += glm::two_pi<float>();
+            set_rotation(angle);
+        }
+
+        _move_speed = _move_speed + _speed_ramp * delta_time; // Increase speed over time
     }
 
     void take_damage(float ammount, Player &player) {
@@ -73,32 +84,38 @@ struct Enemy {
         destroy();
     }   
 
-    void draw(bool bind_material = false) {
-        _model.draw(bind_material);
+    // the model is shared, see ModelTable
+    void draw(Model& model, bool bind_material = false, float alpha = 1.0f) {
+        model.draw(_transform, bind_material, alpha);
     }
 
     void set_rotation(float angle) {
-        _model._transform._rotation.y = angle;
+        _transform._rotation.y = angle;
     }
     
     void set_position(const glm::vec3& pos) {
-        _model._transform._position = pos - _center_offset;
+        _transform._position = pos - _center_offset;
     }
 
     glm::vec3 get_position() const {
-        return _model._transform._position + _center_offset;
+        return _transform._position + _center_offset;
     }
 
     float _move_speed = 0.5f;
+    float _speed_ramp = 0.18f; // speed gained per second
     int _hp = 100;
     int max_hp = 100;
     float _damage = 10.0f;
     int _level = 1;
-    Model _model;
+    ModelId _model_id = 0;
+    Transform _transform;
     glm::vec3 _center_offset = glm::vec3(0.0f);
     float _radius = 1.0f;
     float base_xp = 10.0f;
     State _state = State::ALIVE;
+    // simulation level of detail
+    float _lod_delta = 0.0f; // time not simulated yet
+    uint32_t _lod_phase = 0;
 
 private:
 
@@ -109,7 +126,7 @@ private:
     }
 
     void update_rotation(glm::vec3 player_pos) {
-        _model.look_at(player_pos);
+        _transform.look_at(player_pos);
     }
 
 };
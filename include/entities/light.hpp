@@ -2,6 +2,9 @@
 #include <glbinding/gl46core/gl.h>
 using namespace gl46core;
 #include <glm/glm.hpp>
+#include "draw_stats.hpp"
+#include "gl_debug.hpp"
+#include "gl_handle.hpp"
 
 struct Light {
     void init(glm::vec3 position, glm::vec3 color, float range) {
@@ -10,8 +13,9 @@ struct Light {
         _color = color;
         _range = range;
         // create shadow texture as cube map
-        glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &_shadow_texture);
+        _shadow_texture = GlTexture::create("shadow cube map", static_cast<size_t>(_shadow_width) * _shadow_height * 4 * 6, GL_TEXTURE_CUBE_MAP);
         glTextureStorage2D(_shadow_texture, 1, GL_DEPTH_COMPONENT32F, _shadow_width, _shadow_height);
+        GlDebug::label(GL_TEXTURE, _shadow_texture, "shadow cube map");
         // set wrapping/magnification behavior
         glTextureParameteri(_shadow_texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTextureParameteri(_shadow_texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -27,26 +31,30 @@ struct Light {
         _shadow_views[5] = glm::lookAt(_position, _position + glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f)); // front
     }
     void destroy() {
-        glDeleteTextures(1, &_shadow_texture);
+        _shadow_texture.reset();
     }
     void bind(GLuint offset = 0) {
-        // bind simple light properties
+        // bind simple light properties, an inactive light keeps its slot but adds no color
+        glm::vec3 color = active ? _color : glm::vec3(0.0f);
         glUniform3f(24 + offset, _position.x, _position.y, _position.z);
-        glUniform3f(25 + offset, _color.r, _color.g, _color.b);
+        glUniform3f(25 + offset, color.r, color.g, color.b);
         glUniform1f(26 + offset, _range);
+        DrawStats::count_uniforms(3);
     }
-    void bind_write(GLuint framebuffer, GLuint face_i) {
+    void bind_write(GlFramebufferView framebuffer, GLuint face_i) {
         bind();
         // set framebuffer texture and clear it
         glNamedFramebufferTextureLayer(framebuffer, GL_DEPTH_ATTACHMENT, _shadow_texture, 0, face_i);
         // bind the light view+projection matrices (act like it is the camera)
         glUniformMatrix4fv( 9, 1, false, glm::value_ptr(_shadow_views[face_i]));
         glUniformMatrix4fv(13, 1, false, glm::value_ptr(_shadow_projection));
+        DrawStats::count_uniforms(2);
     }
     void bind_read(GLuint tex_unit, GLuint offset) {
         bind(offset);
         // bind the entire cube map for reading
         glBindTextureUnit(tex_unit, _shadow_texture);
+        DrawStats::count_texture_bind();
     }
     
     glm::vec3 _position = {0, 0, 0};
@@ -55,7 +63,7 @@ struct Light {
     // shadow rendering
     GLuint _shadow_width = 512;
     GLuint _shadow_height = 512;
-    GLuint _shadow_texture; // cube map (6 textures)
+    GlTexture _shadow_texture; // cube map (6 textures)
     std::array<glm::mat4x4, 6> _shadow_views; // one view for each texture in cube map
     glm::mat4x4 _shadow_projection;
     bool active = true;
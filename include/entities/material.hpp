@@ -1,5 +1,6 @@
 #pragma once
 #include <glm/glm.hpp>
+#include "draw_stats.hpp"
 
 struct Material {
     void bind() {
@@ -11,6 +12,7 @@ struct Material {
         glUniform3fv(21, 1, &_ambient[0]);   // Ka (ambient)
         glUniform3fv(22, 1, &_diffuse[0]);   // Kd (diffuse)
         glUniform3fv(23, 1, &_specularColor[0]); // Ks (specular)
+        DrawStats::count_uniforms(6);
     }
 
     float _texture_contribution = 0;           
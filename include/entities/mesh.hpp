@@ -1,9 +1,10 @@
 #pragma once
 #include <vector>
 #include <glm/glm.hpp>
-#include <assimp/mesh.h>
 #include <glbinding/gl46core/gl.h>
 using namespace gl46core;
+#include "draw_stats.hpp"
+#include "gl_handle.hpp"
 
 struct Mesh {
     enum Primitive { eCube, eSphere, Wall};
@@ -170,67 +171,33 @@ struct Mesh {
         }
         describe_layout(vertices, indices);
     }
-    // load mesh from assimp scene
-    void init(aiMesh* mesh_p) {
-        std::vector<Vertex> vertices;
-        vertices.reserve(mesh_p->mNumVertices);
-        for (uint32_t i = 0; i < mesh_p->mNumVertices; i++) {
-            Vertex vertex;
-            // extract positions
-            vertex.position.x = mesh_p->mVertices[i].x;
-            vertex.position.y = mesh_p->mVertices[i].y;
-            vertex.position.z = mesh_p->mVertices[i].z;
-            // extract normals
-            vertex.normal.x = mesh_p->mNormals[i].x;
-            vertex.normal.y = mesh_p->mNormals[i].y;
-            vertex.normal.z = mesh_p->mNormals[i].z;
-            // extract uv/st coords
-            if (mesh_p->HasTextureCoords(0)) {
-                vertex.uv.s = mesh_p->mTextureCoords[0][i].x;
-                vertex.uv.t = mesh_p->mTextureCoords[0][i].y;
-            }
-            else vertex.uv = {0, 0};
-            // extract vertex colors (if present)
-            if (mesh_p->HasVertexColors(0)) {
-                vertex.color.r = mesh_p->mColors[0][i].r;
-                vertex.color.g = mesh_p->mColors[0][i].g;
-                vertex.color.b = mesh_p->mColors[0][i].b;
-                vertex.color.a = mesh_p->mColors[0][i].a;
-            }
-            else vertex.color = {1, 1, 1, 1};
-            vertices.push_back(vertex);
-        }
-
-        std::vector<uint32_t> indices;
-        indices.reserve(mesh_p->mNumFaces * 3);
-        for (int i = 0; i < mesh_p->mNumFaces; i++) {
-            aiFace face = mesh_p->mFaces[i];
-            assert(face.mNumIndices == 3);
-            for (int j = 0; j < face.mNumIndices; j++) {
-                indices.push_back(face.mIndices[j]);
-            }
-        }
-        _material_index = mesh_p->mMaterialIndex;
-        describe_layout(vertices, indices);
+    // load mesh from vertex/index data already in gpu layout (imported or memory mapped)
+    void init(const Vertex* vertices_p, size_t vertex_count, const uint32_t* indices_p, size_t index_count, uint32_t material_index) {
+        _material_index = material_index;
+        describe_layout(vertices_p, vertex_count, indices_p, index_count);
     }
     // describe memory layout
     void describe_layout(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
-        _index_count = indices.size();
+        describe_layout(vertices.data(), vertices.size(), indices.data(), indices.size());
+    }
+    void describe_layout(const Vertex* vertices_p, size_t vertex_count, const uint32_t* indices_p, size_t index_count) {
+        _index_count = index_count;
 
         // describe vertex buffer
-        GLsizeiptr vertex_byte_count = vertices.size() * sizeof(Vertex);
-        glCreateBuffers(1, &_vertex_buffer_object);
+        GLsizeiptr vertex_byte_count = vertex_count * sizeof(Vertex);
+        GLsizeiptr element_byte_count = index_count * sizeof(uint32_t);
+        _gpu_bytes = vertex_byte_count + element_byte_count;
+        _vertex_buffer_object = GlBuffer::create("mesh vertices", vertex_byte_count);
         // upload data to GPU buffer
-        glNamedBufferStorage(_vertex_buffer_object, vertex_byte_count, vertices.data(), BufferStorageMask::GL_NONE_BIT);
+        glNamedBufferStorage(_vertex_buffer_object, vertex_byte_count, vertices_p, BufferStorageMask::GL_NONE_BIT);
 
         // describe index buffer (element buffer)
-        GLsizeiptr element_byte_count = indices.size() * sizeof(uint32_t);
-        glCreateBuffers(1, &_element_buffer_object);
+        _element_buffer_object = GlBuffer::create("mesh indices", element_byte_count);
         // upload data to GPU buffer
-        glNamedBufferStorage(_element_buffer_object, element_byte_count, indices.data(), BufferStorageMask::GL_NONE_BIT);
+        glNamedBufferStorage(_element_buffer_object, element_byte_count, indices_p, BufferStorageMask::GL_NONE_BIT);
 
         // create vertex array buffer
-        glCreateVertexArrays(1, &_vertex_array_object);
+        _vertex_array_object = GlVertexArray::create("mesh");
         // assign both vertex and index (element) buffers
         glVertexArrayVertexBuffer(_vertex_array_object, 0, _vertex_buffer_object, 0, sizeof(Vertex));
         glVertexArrayElementBuffer(_vertex_array_object, _element_buffer_object);
@@ -275,21 +242,24 @@ struct Mesh {
         glVertexArrayAttribBinding(_vertex_array_object, 3, 0);
         glEnableVertexArrayAttrib(_vertex_array_object, 3);
     }
-    // clean up mesh buffers
+    // clean up mesh buffers, also happens when the mesh is destroyed
     void destroy() {
-        glDeleteBuffers(1, &_vertex_buffer_object);
-        glDeleteBuffers(1, &_element_buffer_object);
-        glDeleteVertexArrays(1, &_vertex_array_object);
+        _vertex_array_object.reset();
+        _vertex_buffer_object.reset();
+        _element_buffer_object.reset();
     }
     // draw the mesh using previously bound pipeline
     void draw() {
         glBindVertexArray(_vertex_array_object);
         glDrawElements(GL_TRIANGLES, _index_count, GL_UNSIGNED_INT, nullptr);
+        DrawStats::count_vao_bind();
+        DrawStats::count_draw(static_cast<uint32_t>(_index_count) / 3);
     }
 
-    GLuint _vertex_buffer_object;
-    GLuint _element_buffer_object;
-    GLuint _vertex_array_object;
+    GlBuffer _vertex_buffer_object;
+    GlBuffer _element_buffer_object;
+    GlVertexArray _vertex_array_object;
     GLsizei _index_count;
     uint32_t _material_index = 0;
+    size_t _gpu_bytes = 0; // vertex + index buffer size
 };
\ No newline at end of file
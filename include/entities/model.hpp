@@ -1,13 +1,10 @@
 #pragma once
 #include <fmt/base.h>
-#include <assimp/Importer.hpp>
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
-#include <assimp/material.h>
 #include "transform.hpp"
 #include "material.hpp"
 #include "texture.hpp"
 #include "mesh.hpp"
+#include "mesh_cache.hpp"
 
 struct Model {
     void init(Mesh::Primitive primitive) {
@@ -28,118 +25,135 @@ struct Model {
         _textures.emplace_back().init(texture_path);
         _materials.emplace_back()._texture_contribution = 1.0;
     }
-    void init(std::string model_path) {
-        Assimp::Importer importer;
-
-        // flags that allow some automatic post processing of model
-        unsigned int flags = 0; // https://assimp.sourceforge.net/lib_html/postprocess_8h.html
-        flags |= aiProcess_Triangulate; // triangulate all faces if not already triangulated
-        flags |= aiProcess_GenNormals; // generate normals if they dont exist
-        flags |= aiProcess_FlipUVs; // OpenGL prefers flipped y axis
-        flags |= aiProcess_PreTransformVertices; // simplifies model load
-
-        // load the entire "scene" (may be multiple meshes, hence scene)
-        const aiScene* scene_p = importer.ReadFile(model_path, flags);
-        if (scene_p == nullptr) {
-            fmt::println("{}", importer.GetErrorString());
-            return;
-        }
+    // everything needed to create the model on the gpu, can be read on any thread
+    struct Source {
+        bool valid = false;
+        bool from_cache = false;
+        FileData cache_file;
+        MeshCache::View cache; // points into cache_file
+        ModelData data; // only filled when there was no usable cache
+        std::vector<Texture::Image> images; // decoded diffuse textures per material
+    };
+    // read from the binary mesh cache, the source model is only imported when the cache is missing or stale
+    // import temporaries go to scratch_p, the source itself is handed on and stays on the heap
+    static auto read(const std::string& model_path, std::pmr::memory_resource* scratch_p = std::pmr::get_default_resource()) -> Source {
+        Source source;
 
         // figure out path to the model root for stuff like .obj, which puts its assets into sub-folders
         size_t separator_index = model_path.find_last_of('/');
         std::string model_root = model_path.substr(0, separator_index + 1);
 
-        // create materials and textures
-        _materials.resize(scene_p->mNumMaterials);
-        _textures.resize(scene_p->mNumMaterials);
-        for (uint32_t i = 0; i < scene_p->mNumMaterials; i++) {
-            aiMaterial* material_p = scene_p->mMaterials[i];
-            Material& material = _materials[i];
-
-            // load basic material properties
-            material_p->Get(AI_MATKEY_SHININESS, material._specular);
-            material_p->Get(AI_MATKEY_SHININESS_STRENGTH, material._specular_shininess);
-
-            aiColor3D color;
-
-            // Ka 
-            if (material_p->Get(AI_MATKEY_COLOR_AMBIENT, color) == AI_SUCCESS) {
-                material._ambient = glm::vec3(color.r, color.g, color.b); 
-            } else {
-                material._ambient = glm::vec3(0.1f); 
+        // the archive always carries a baked cache, loose files check the timestamps
+        std::string cache_path = MeshCache::cache_path(model_path);
+        bool use_cache = Files::packed()
+            ? Files::exists(cache_path)
+            : MeshCache::is_fresh(Files::loose_path(cache_path), Files::loose_path(model_path));
+        if (use_cache) source.cache_file = Files::load(cache_path);
+        if (source.cache.open(source.cache_file, cache_path)) {
+            source.from_cache = true;
+            source.images.resize(source.cache.header().material_count);
+            for (uint32_t i = 0; i < source.images.size(); i++) {
+                const char* texture_path = source.cache.material(i).texture_path;
+                if (texture_path[0] != '\0') source.images[i] = Texture::decode((model_root + texture_path).c_str());
             }
-
-            // Kd 
-            if (material_p->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS) {
-                material._diffuse = glm::vec3(color.r, color.g, color.b);
-            } else {
-                material._diffuse = glm::vec3(0.76f, 0.70f, 0.50f); 
-            }
-
-            // Ks 
-            if (material_p->Get(AI_MATKEY_COLOR_SPECULAR, color) == AI_SUCCESS) {
-                material._specularColor = glm::vec3(color.r, color.g, color.b);
-            } else {
-                material._specularColor = glm::vec3(0.1f, 0.1f, 0.1f); 
-            }
-
-            // Ns (Shininess)
-            if (material_p->Get(AI_MATKEY_SHININESS, material._specular_shininess) != AI_SUCCESS) {
-                material._specular_shininess = 4.0f; 
+        }
+        else {
+            if (!MeshCache::import(model_path, source.data, scratch_p)) return source;
+            if (!Files::packed()) MeshCache::write(Files::loose_path(cache_path), source.data);
+            source.images.resize(source.data.materials.size());
+            for (uint32_t i = 0; i < source.data.texture_paths.size(); i++) {
+                const std::string& texture_path = source.data.texture_paths[i];
+                if (!texture_path.empty()) source.images[i] = Texture::decode((model_root + texture_path).c_str());
             }
+        }
+        source.valid = true;
+        return source;
+    }
 
-
-            // see if this should use a diffuse texture
-            if (material_p->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
-                material._texture_contribution = 1.0;
-                // load the texture
-                aiString texture_path;
-                material_p->Get(AI_MATKEY_TEXTURE(aiTextureType_DIFFUSE, 0), texture_path);
-                std::string full_texture_path = model_root;
-                full_texture_path.append(texture_path.C_Str());
-                _textures[i].init(full_texture_path.c_str());
-            } else {
-                material._texture_contribution = 0.0;
-            }
+    void init(const std::string& model_path) {
+        init(read(model_path));
+    }
+    void init(const Source& source) {
+        if (!source.valid) return;
+        if (source.from_cache) init(source.cache, source.images);
+        else init(source.data, source.images);
+        _from_cache = source.from_cache;
+    }
+    // upload straight from the cache, which points into the archive or a mapped file
+    void init(const MeshCache::View& cache, const std::vector<Texture::Image>& images) {
+        const MeshCache::Header& header = cache.header();
+        _materials.resize(header.material_count);
+        _textures.resize(header.material_count);
+        for (uint32_t i = 0; i < header.material_count; i++) {
+            const MeshCache::MaterialRecord& record = cache.material(i);
+            Material& material = _materials[i];
+            material._texture_contribution = record.texture_contribution;
+            material._specular = record.specular;
+            material._specular_shininess = record.specular_shininess;
+            material._ambient = record.ambient;
+            material._diffuse = record.diffuse;
+            material._specularColor = record.specular_color;
+            if (images[i].pixels_p != nullptr) _textures[i].init(images[i]);
+        }
+        _meshes.resize(header.mesh_count);
+        for (uint32_t i = 0; i < header.mesh_count; i++) {
+            const MeshCache::MeshRecord& record = cache.mesh(i);
+            _meshes[i].init(cache.vertices(i), record.vertex_count, cache.indices(i), record.index_count, record.material_index);
+        }
+        _bounds_min = header.bounds_min;
+        _bounds_max = header.bounds_max;
+    }
+    void init(const ModelData& data, const std::vector<Texture::Image>& images) {
+        _materials = data.materials;
+        _textures.resize(data.materials.size());
+        for (uint32_t i = 0; i < images.size(); i++) {
+            if (images[i].pixels_p != nullptr) _textures[i].init(images[i]);
         }
-        
-        // create meshes
-        _meshes.resize(scene_p->mNumMeshes);
-        for (uint32_t i = 0; i < scene_p->mNumMeshes; i++) {
-            aiMesh* mesh_p = scene_p->mMeshes[i];
-            _meshes[i].init(mesh_p);
+        _meshes.resize(data.meshes.size());
+        for (uint32_t i = 0; i < data.meshes.size(); i++) {
+            const ModelData::MeshData& mesh = data.meshes[i];
+            _meshes[i].init(mesh.vertices.data(), mesh.vertices.size(), mesh.indices.data(), mesh.indices.size(), mesh.material_index);
         }
+        _bounds_min = data.bounds_min;
+        _bounds_max = data.bounds_max;
     }
     void destroy() {
-        for (auto texture: _textures) {
+        for (auto& texture: _textures) {
             texture.destroy();
         }
-        for (auto mesh: _meshes) {
+        for (auto& mesh: _meshes) {
             mesh.destroy();
         }
     }
             
-void draw(bool color = true) {
-    _transform.bind();
-    for (uint32_t i = 0; i < _meshes.size(); i++) {
-        uint32_t material_index = _meshes[i]._material_index;
+    void draw(bool color = true, float alpha = 1.0f) {
+        draw(_transform, color, alpha);
+    }
+    // draw with a transform owned by someone else (shared models)
+    void draw(const Transform& transform, bool color = true, float alpha = 1.0f) {
+        transform.bind(alpha);
+        for (uint32_t i = 0; i < _meshes.size(); i++) {
+            uint32_t material_index = _meshes[i]._material_index;
+
+            if (material_index < _textures.size() && color) {
+                _textures[material_index].bind(); 
+                DrawStats::count_texture_bind();
+            }
+            _materials[material_index].bind();   
 
-        if (material_index < _textures.size() && color) {
-            _textures[material_index].bind(); 
+            _meshes[i].draw();                   
         }
-        _materials[material_index].bind();   
-
-        _meshes[i].draw();                   
     }
+
+    auto gpu_bytes() const -> size_t {
+        size_t bytes = 0;
+        for (const auto& mesh: _meshes) bytes += mesh._gpu_bytes;
+        for (const auto& texture: _textures) bytes += texture._gpu_bytes;
+        return bytes;
     }
 
     void look_at(const glm::vec3& target_position) {
-        glm::vec3 direction = glm::normalize(target_position - _transform._position);
-        float angle = std::atan2(direction.x, direction.z);
-
-        if (angle < 0) angle += glm::two_pi<float>();
-
-        _transform._rotation.y = angle;
+        _transform.look_at(target_position);
     }
 
 
@@ -147,4 +161,7 @@ void draw(bool color = true) {
     std::vector<Material> _materials;
     std::vector<Texture> _textures; 
     Transform _transform;
+    glm::vec3 _bounds_min = glm::vec3(0.0f);
+    glm::vec3 _bounds_max = glm::vec3(0.0f);
+    bool _from_cache = false; // loaded from the binary mesh cache instead of the source file
 };
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include <glm/gtc/constants.hpp>
 #include <string>
 #include <cmath>
-#include "entities/model.hpp"
+#include "assets.hpp"
 #include "input.hpp"
 #include <iostream>
 
@@ -12,13 +12,12 @@
 struct Player {
 public:
 
-    void init(const std::string& model_path, const glm::vec3& center_offset = glm::vec3(0.0f)) {
-        _model.init(model_path);
+    void init(ModelId model, const glm::vec3& center_offset = glm::vec3(0.0f)) {
+        _model_id = model;
         _center_offset = center_offset;  
     }
 
     void destroy() {
-        _model.destroy();
     }
 
     void update(float delta_time, float window_width, float window_height, const glm::mat4& projection_mat, const glm::mat4& inv_view_mat) {
@@ -35,8 +34,9 @@ public:
         if (_hp < 0) _hp = 0;
     }
 
-    void draw(bool bind_material = false) {
-        _model.draw(bind_material);
+    // the model is owned by the AssetManager
+    void draw(Model& model, bool bind_material = false, float alpha = 1.0f) {
+        model.draw(_transform, bind_material, alpha);
     }
 
     void gain_xp(float amount) {
@@ -50,15 +50,15 @@ public:
     }
 
     void set_rotation(float angle) {
-        _model._transform._rotation.y = angle;
+        _transform._rotation.y = angle;
     }
 
     float get_rotation() const {
-        return _model._transform._rotation.y;
+        return _transform._rotation.y;
     }
     
     void set_position(const glm::vec3& pos) {
-        _model._transform._position = pos - _center_offset;  
+        _transform._position = pos - _center_offset;  
     }
 
     glm::vec3 get_mouse_world_position() const {
@@ -66,7 +66,12 @@ public:
     }
 
     glm::vec3 get_position() const {
-        return _model._transform._position + _center_offset;
+        return _transform._position + _center_offset;
+    }
+
+    // position blended between the last two simulation ticks
+    glm::vec3 get_render_position(float alpha) const {
+        return _transform.interpolate_position(alpha) + _center_offset;
     }
 
     float get_radius() const { return _radius; } 
@@ -90,7 +95,8 @@ public:
     int _level = 1;
     int _xp_needed = 100.0f;
     float _radius = 0.8f;
-    Model _model;
+    ModelId _model_id = 0;
+    Transform _transform;
     glm::vec3 _center_offset = glm::vec3(0.0f); 
     bool _showLevelUpWindow = false;
 
@@ -108,9 +114,9 @@ private:
 
         if (glm::length(movement) > 0) {
             movement = glm::normalize(movement);
-            _model._transform._position += movement * _move_speed * delta_time;
-            _model._transform._position.x = glm::clamp(_model._transform._position.x, -95.0f, 95.0f);
-            _model._transform._position.z = glm::clamp(_model._transform._position.z, -95.0f, 95.0f);
+            _transform._position += movement * _move_speed * delta_time;
+            _transform._position.x = glm::clamp(_transform._position.x, -95.0f, 95.0f);
+            _transform._position.z = glm::clamp(_transform._position.z, -95.0f, 95.0f);
         }
         
     }
@@ -148,7 +154,7 @@ private:
             return; 
         }
         // Rotate model to mouse
-        _model.look_at(world_mouse_pos);
+        _transform.look_at(world_mouse_pos);
     }
 
     glm::mat4 get_inverse_view_matrix(const glm::vec3& camera_pos, const glm::vec3& camera_rot) {
@@ -1,21 +1,40 @@
 #pragma once
+#include <memory>
 #include <fmt/base.h>
 #include <glbinding/gl46core/gl.h>
 using namespace gl46core;
 #include <stb_image.h>
+#include "files.hpp"
+#include "gl_handle.hpp"
 
 struct Texture {
+    // decoded rgba pixels, can be decoded on any thread
+    struct Image {
+        std::unique_ptr<stbi_uc, void(*)(void*)> pixels_p = { nullptr, stbi_image_free };
+        int width = 0;
+        int height = 0;
+    };
+    static auto decode(const char* path) -> Image {
+        Image image;
+        int channel_count; // output for stbi_load_from_memory
+        FileData file = Files::load(path);
+        image.pixels_p.reset(stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &image.width, &image.height, &channel_count, 4)); // explicitly ask for 4 channels
+        if (image.pixels_p == nullptr) fmt::println("Failed to load texture: {}", path);
+        return image;
+    }
+
     void init(const char* path) {
-        // load image
-        int width, height, channel_count; // output for stbi_load_from_memory
-        stbi_uc* image_p = stbi_load(path, &width, &height, &channel_count, 4); // explicitly ask for 4 channels
-        if (image_p == nullptr) fmt::println("Failed to load texture: {}", path);
+        init(decode(path));
+    }
+    void init(const Image& image) {
+        int width = image.width;
+        int height = image.height;
+        // 4 bytes per texel, the mip chain adds about a third
+        _gpu_bytes = static_cast<size_t>(width) * height * 4 * 4 / 3;
         // create texture to store image in (texture is gpu buffer)
-        glCreateTextures(GL_TEXTURE_2D, 1, &_texture);
+        _texture = GlTexture::create("texture", _gpu_bytes, GL_TEXTURE_2D);
         glTextureStorage2D(_texture, 4, GL_RGBA8, width, height);
-        glTextureSubImage2D(_texture, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, image_p);
-        // free image on cpu side
-        stbi_image_free(image_p);
+        glTextureSubImage2D(_texture, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels_p.get());
         // sampler parameters
         glTextureParameteri(_texture, GL_TEXTURE_WRAP_S, GL_REPEAT); // s is the u coordinate (width)
         glTextureParameteri(_texture, GL_TEXTURE_WRAP_T, GL_REPEAT); // t is the v coordinate (height)
@@ -24,12 +43,14 @@ struct Texture {
         // generate mipmap textures
         glGenerateTextureMipmap(_texture);
     } 
+    // also happens when the texture is destroyed
     void destroy() {
-        glDeleteTextures(1, &_texture);
+        _texture.reset();
     }
     void bind() {
         glBindTextureUnit(0, _texture);
     }
 
-    GLuint _texture;
+    GlTexture _texture;
+    size_t _gpu_bytes = 0;
 };
\ No newline at end of file
@@ -4,25 +4,66 @@ using namespace gl46core;
 #include <glm/glm.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/constants.hpp>
+#include <cmath>
+#include "draw_stats.hpp"
 
 struct Transform {
-    void bind() {
+    // alpha blends between the previous tick (0) and the current tick (1)
+    void bind(float alpha = 1.0f) const {
+        glm::vec3 position = interpolate_position(alpha);
+        glm::vec3 rotation = interpolate_rotation(alpha);
         // initialize to identity matrix
         glm::mat4x4 transform_matrix(1.0);
         glm::mat4x4 normal_matrix(1.0);
         // calculate transform/model matrix from transform components
-        transform_matrix = glm::translate(transform_matrix, _position);
-        normal_matrix = glm::rotate(normal_matrix, _rotation.x, glm::vec3(1, 0, 0));
-        normal_matrix = glm::rotate(normal_matrix, _rotation.y, glm::vec3(0, 1, 0));
-        normal_matrix = glm::rotate(normal_matrix, _rotation.z, glm::vec3(0, 0, 1));
+        transform_matrix = glm::translate(transform_matrix, position);
+        normal_matrix = glm::rotate(normal_matrix, rotation.x, glm::vec3(1, 0, 0));
+        normal_matrix = glm::rotate(normal_matrix, rotation.y, glm::vec3(0, 1, 0));
+        normal_matrix = glm::rotate(normal_matrix, rotation.z, glm::vec3(0, 0, 1));
         transform_matrix = transform_matrix * normal_matrix;
         transform_matrix = glm::scale(transform_matrix, _scale);
         // upload to GPU
         glUniformMatrix4fv(1, 1, false, glm::value_ptr(transform_matrix));
         glUniformMatrix4fv(5, 1, false, glm::value_ptr(normal_matrix));
+        DrawStats::count_uniforms(2);
+    }
+
+    // turn around the y axis to face a point
+    void look_at(const glm::vec3& target_position) {
+        glm::vec3 direction = glm::normalize(target_position - _position);
+        float angle = std::atan2(direction.x, direction.z);
+
+        if (angle < 0) angle += glm::two_pi<float>();
+
+        _rotation.y = angle;
+    }
+
+    // remember the current state as the start of the next interpolation
+    void snapshot() {
+        _previous_position = _position;
+        _previous_rotation = _rotation;
+    }
+
+    glm::vec3 interpolate_position(float alpha) const {
+        if (alpha >= 1.0f) return _position;
+        return glm::mix(_previous_position, _position, alpha);
+    }
+
+    glm::vec3 interpolate_rotation(float alpha) const {
+        if (alpha >= 1.0f) return _rotation;
+        // take the short way around for wrapped angles
+        glm::vec3 delta;
+        for (int i = 0; i < 3; i++) {
+            delta[i] = std::remainder(_rotation[i] - _previous_rotation[i], glm::two_pi<float>());
+        }
+        return _previous_rotation + delta * alpha;
     }
 
     glm::vec3 _position = glm::vec3(0, 0, 0);
     glm::vec3 _rotation = glm::vec3(0, 0, 0); // euler angles
     glm::vec3 _scale = glm::vec3(1, 1, 1);
+    // state at the previous simulation tick
+    glm::vec3 _previous_position = glm::vec3(0, 0, 0);
+    glm::vec3 _previous_rotation = glm::vec3(0, 0, 0);
 };
\ No newline at end of file
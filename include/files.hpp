@@ -0,0 +1,198 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <filesystem>
+#include <fmt/base.h>
+#include <SDL3/SDL_filesystem.h>
+#include "mapped_file.hpp"
+#ifdef ARCHIVE_LZ4
+    #include <lz4.h>
+#endif
+
+// packed asset archive (assets.pak), built from assets/ by the asset-packer target
+// layout: Header, Entry[table_size] (open addressing hash table), names, then the 4K aligned entry data
+namespace Archive {
+    static constexpr char magic[4] = { 'P', 'A', 'K', '1' };
+    static constexpr uint32_t version = 1;
+    static constexpr uint64_t alignment = 4096; // entries start on a page so they can be mapped directly
+
+    enum class Compression : uint32_t { eNone, eLZ4 };
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t entry_count;
+        uint32_t table_size; // power of two, at least twice the entry count
+        uint64_t names_offset;
+    };
+    struct Entry {
+        uint64_t hash; // 0 marks an empty slot
+        uint64_t offset;
+        uint64_t size; // uncompressed
+        uint64_t stored_size;
+        uint32_t name_offset; // relative to names_offset
+        uint32_t name_length;
+        Compression compression;
+        uint32_t padding;
+    };
+
+    // FNV-1a, never returns 0 so it can double as the empty marker
+    inline auto hash(std::string_view name) -> uint64_t {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (char c: name) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3ull;
+        }
+        return hash == 0 ? 1 : hash;
+    }
+}
+
+// bytes of one asset file, either a view into the archive mapping or owned by this object
+struct FileData {
+    auto data() const -> const uint8_t* { return _data_p; }
+    auto size() const -> size_t { return _size; }
+    auto text() const -> std::string_view { return std::string_view(reinterpret_cast<const char*>(_data_p), _size); }
+    explicit operator bool() const { return _data_p != nullptr; }
+
+    const uint8_t* _data_p = nullptr;
+    size_t _size = 0;
+    MappedFile _mapping; // loose files
+    std::vector<uint8_t> _buffer; // decompressed archive entries
+};
+
+// every asset is read through here by its name relative to assets/ ("models/Shark.obj")
+// the archive is mapped once, loose files are the fallback for development
+namespace Files {
+    struct Data {
+        MappedFile archive;
+        const Archive::Header* header_p = nullptr;
+        const Archive::Entry* table_p = nullptr;
+        std::string loose_root;
+
+        static Data& get() {
+            static Data instance;
+            return instance;
+        }
+    };
+
+    // use the archive next to the executable unless ASSETS_LOOSE is set or there is none
+    inline void init() {
+        Data& data = Data::get();
+        const char* base_path_p = SDL_GetBasePath();
+        std::string base_path = base_path_p ? base_path_p : "";
+        data.loose_root = base_path + "../assets/";
+        if (std::getenv("ASSETS_LOOSE") != nullptr) return;
+
+        std::string archive_path = base_path + "assets.pak";
+        if (!data.archive.open(archive_path.c_str())) {
+            fmt::println("No asset archive at {}, using loose files from {}", archive_path, data.loose_root);
+            return;
+        }
+        data.header_p = data.archive.at<Archive::Header>(0);
+        if (data.header_p == nullptr
+            || std::memcmp(data.header_p->magic, Archive::magic, sizeof(Archive::magic)) != 0
+            || data.header_p->version != Archive::version
+            || (data.header_p->table_size & (data.header_p->table_size - 1)) != 0) {
+            fmt::println("Broken asset archive {}, using loose files", archive_path);
+            data.header_p = nullptr;
+            data.archive.close();
+            return;
+        }
+        data.table_p = data.archive.at<Archive::Entry>(sizeof(Archive::Header), data.header_p->table_size);
+        if (data.table_p == nullptr) {
+            fmt::println("Truncated asset archive {}, using loose files", archive_path);
+            data.header_p = nullptr;
+            data.archive.close();
+        }
+    }
+    // tools read loose files relative to a root of their choice
+    inline void init_loose(const std::string& root) {
+        Data& data = Data::get();
+        data.archive.close();
+        data.header_p = nullptr;
+        data.table_p = nullptr;
+        data.loose_root = root;
+    }
+    inline void destroy() {
+        Data& data = Data::get();
+        data.archive.close();
+        data.header_p = nullptr;
+        data.table_p = nullptr;
+    }
+
+    inline bool packed() { return Data::get().header_p != nullptr; }
+
+    // full path of a loose file, only meaningful when not packed
+    inline auto loose_path(std::string_view name) -> std::string {
+        return Data::get().loose_root + std::string(name);
+    }
+
+    inline auto find(std::string_view name) -> const Archive::Entry* {
+        Data& data = Data::get();
+        if (data.header_p == nullptr) return nullptr;
+        uint64_t hash = Archive::hash(name);
+        uint32_t mask = data.header_p->table_size - 1;
+        // linear probing, the table is at most half full so this ends quickly
+        for (uint32_t slot = hash & mask, probes = 0; probes <= mask; slot = (slot + 1) & mask, probes++) {
+            const Archive::Entry& entry = data.table_p[slot];
+            if (entry.hash == 0) return nullptr;
+            if (entry.hash != hash || entry.name_length != name.size()) continue;
+            const char* entry_name_p = data.archive.at<char>(data.header_p->names_offset + entry.name_offset, entry.name_length);
+            if (entry_name_p != nullptr && name == std::string_view(entry_name_p, entry.name_length)) return &entry;
+        }
+        return nullptr;
+    }
+
+    inline bool exists(std::string_view name) {
+        std::error_code error;
+        return packed() ? find(name) != nullptr : std::filesystem::is_regular_file(loose_path(name), error);
+    }
+
+    // uncompressed archive entries are returned without copying
+    inline auto load(std::string_view name) -> FileData {
+        FileData file;
+        if (!packed()) {
+            if (file._mapping.open(loose_path(name).c_str())) {
+                file._data_p = file._mapping.data();
+                file._size = file._mapping.size();
+            }
+            else fmt::println("Failed to open file: {}", loose_path(name));
+            return file;
+        }
+
+        const Archive::Entry* entry_p = find(name);
+        if (entry_p == nullptr) {
+            fmt::println("File not in asset archive: {}", name);
+            return file;
+        }
+        const uint8_t* stored_p = Data::get().archive.at<uint8_t>(entry_p->offset, entry_p->stored_size);
+        if (stored_p == nullptr) {
+            fmt::println("Truncated archive entry: {}", name);
+            return file;
+        }
+        switch (entry_p->compression) {
+            case Archive::Compression::eNone:
+                file._data_p = stored_p;
+                file._size = entry_p->size;
+                break;
+            case Archive::Compression::eLZ4:
+#ifdef ARCHIVE_LZ4
+                file._buffer.resize(entry_p->size);
+                if (LZ4_decompress_safe(reinterpret_cast<const char*>(stored_p), reinterpret_cast<char*>(file._buffer.data()),
+                        static_cast<int>(entry_p->stored_size), static_cast<int>(entry_p->size)) == static_cast<int>(entry_p->size)) {
+                    file._data_p = file._buffer.data();
+                    file._size = file._buffer.size();
+                }
+                else fmt::println("Failed to decompress archive entry: {}", name);
+#else
+                fmt::println("Archive entry is LZ4 compressed but LZ4 support is not built in: {}", name);
+#endif
+                break;
+        }
+        return file;
+    }
+}
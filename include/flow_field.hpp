@@ -0,0 +1,183 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+// grid over the arena (xz plane) where every cell stores the direction towards a target
+// the field is only rebuilt when the target moves into another cell
+struct FlowField {
+    void init(float half_extent, float cell_size) {
+        _half_extent = half_extent;
+        _cell_size = cell_size;
+        _cells_per_side = static_cast<int>(std::ceil(2.0f * half_extent / cell_size));
+        int cell_count = _cells_per_side * _cells_per_side;
+        _offsets = std::make_unique<Offset[]>(cell_count);
+        _directions = std::make_unique<glm::vec2[]>(cell_count);
+        _target_cell_x = -1;
+        _target_cell_y = -1;
+    }
+
+    // returns true if the field had to be rebuilt
+    bool update(const glm::vec3& target) {
+        _target = glm::vec2(target.x, target.z);
+        int cell_x = cell_coord(_target.x);
+        int cell_y = cell_coord(_target.y);
+        if (cell_x == _target_cell_x && cell_y == _target_cell_y) return false;
+        _target_cell_x = cell_x;
+        _target_cell_y = cell_y;
+        rebuild();
+        return true;
+    }
+
+    // unit direction towards the target (xz)
+    glm::vec2 sample(const glm::vec2& position) const {
+        int cell_x = cell_coord(position.x);
+        int cell_y = cell_coord(position.y);
+        // the coarse field cannot resolve the last few cells, steer directly there
+        if (std::abs(cell_x - _target_cell_x) <= 1 && std::abs(cell_y - _target_cell_y) <= 1) {
+            glm::vec2 to_target = _target - position;
+            float length_sq = glm::dot(to_target, to_target);
+            if (length_sq < 1e-6f) return glm::vec2(0.0f);
+            return to_target * (1.0f / std::sqrt(length_sq));
+        }
+        return _directions[cell_y * _cells_per_side + cell_x];
+    }
+
+private:
+    // offset (in cells) from a cell to the target cell, propagated through the grid
+    struct Offset { int16_t x, y; };
+
+    int cell_coord(float world) const {
+        int coord = static_cast<int>((world + _half_extent) / _cell_size);
+        return std::clamp(coord, 0, _cells_per_side - 1);
+    }
+
+    static int length_sq(const Offset& offset) {
+        return offset.x * offset.x + offset.y * offset.y;
+    }
+
+    // take the neighbor's route if it leads to a closer target
+    void relax(int x, int y, int dx, int dy) {
+        int nx = x + dx, ny = y + dy;
+        if (nx < 0 || ny < 0 || nx >= _cells_per_side || ny >= _cells_per_side) return;
+        Offset& offset = _offsets[y * _cells_per_side + x];
+        const Offset& neighbor = _offsets[ny * _cells_per_side + nx];
+        Offset candidate = { static_cast<int16_t>(neighbor.x + dx), static_cast<int16_t>(neighbor.y + dy) };
+        if (length_sq(candidate) < length_sq(offset)) offset = candidate;
+    }
+
+    void rebuild() {
+        const int n = _cells_per_side;
+        const Offset unreached = { INT16_MAX / 2, INT16_MAX / 2 };
+        std::fill_n(_offsets.get(), n * n, unreached);
+        _offsets[_target_cell_y * n + _target_cell_x] = { 0, 0 };
+
+        // 8SSEDT: two sweeps over the grid propagate the offsets, no queue needed
+        for (int y = 0; y < n; y++) {
+            for (int x = 0; x < n; x++) {
+                relax(x, y, -1,  0);
+                relax(x, y,  0, -1);
+                relax(x, y, -1, -1);
+                relax(x, y,  1, -1);
+            }
+            for (int x = n - 1; x >= 0; x--) relax(x, y, 1, 0);
+        }
+        for (int y = n - 1; y >= 0; y--) {
+            for (int x = n - 1; x >= 0; x--) {
+                relax(x, y,  1,  0);
+                relax(x, y,  0,  1);
+                relax(x, y, -1,  1);
+                relax(x, y,  1,  1);
+            }
+            for (int x = 0; x < n; x++) relax(x, y, -1, 0);
+        }
+
+        // cache the normalized direction so sampling is a single load
+        for (int i = 0; i < n * n; i++) {
+            const Offset& offset = _offsets[i];
+            glm::vec2 direction(offset.x, offset.y);
+            int length = length_sq(offset);
+            if (length > 0) direction = direction * (1.0f / std::sqrt(static_cast<float>(length)));
+            _directions[i] = direction;
+        }
+    }
+
+    std::unique_ptr<Offset[]> _offsets;
+    std::unique_ptr<glm::vec2[]> _directions;
+    glm::vec2 _target = glm::vec2(0.0f);
+    float _half_extent = 100.0f;
+    float _cell_size = 2.0f;
+    int _cells_per_side = 0;
+    int _target_cell_x = -1;
+    int _target_cell_y = -1;
+};
+
+// uniform grid that buckets points (xz) for neighbor queries, rebuilt every tick
+struct SpatialGrid {
+    void init(float half_extent, float cell_size, uint32_t capacity) {
+        _half_extent = half_extent;
+        _cell_size = cell_size;
+        _cells_per_side = static_cast<int>(std::ceil(2.0f * half_extent / cell_size));
+        _cell_starts = std::make_unique<uint32_t[]>(_cells_per_side * _cells_per_side + 1);
+        _items = std::make_unique<uint32_t[]>(capacity);
+        _item_cells = std::make_unique<uint32_t[]>(capacity);
+    }
+
+    // counting sort of the points into their cells, points must stay alive until the next build
+    void build(const glm::vec2* positions_p, uint32_t count) {
+        const int cell_count = _cells_per_side * _cells_per_side;
+        _positions_p = positions_p;
+        std::fill_n(_cell_starts.get(), cell_count + 1, 0u);
+        for (uint32_t i = 0; i < count; i++) {
+            _item_cells[i] = cell_index(positions_p[i]);
+            _cell_starts[_item_cells[i] + 1]++;
+        }
+        for (int c = 0; c < cell_count; c++) _cell_starts[c + 1] += _cell_starts[c];
+        // scatter, this moves every start to the end of its cell
+        for (uint32_t i = 0; i < count; i++) _items[_cell_starts[_item_cells[i]]++] = i;
+        for (int c = cell_count; c > 0; c--) _cell_starts[c] = _cell_starts[c - 1];
+        _cell_starts[0] = 0;
+    }
+
+    // sum of pushes away from nearby points, stronger the closer they are
+    glm::vec2 separation(const glm::vec2& position, float radius, uint32_t max_neighbors = 12) const {
+        const float radius_sq = radius * radius;
+        const int cell_x = cell_coord(position.x);
+        const int cell_y = cell_coord(position.y);
+        glm::vec2 push(0.0f);
+        uint32_t neighbors = 0;
+        for (int y = std::max(cell_y - 1, 0); y <= std::min(cell_y + 1, _cells_per_side - 1); y++) {
+            for (int x = std::max(cell_x - 1, 0); x <= std::min(cell_x + 1, _cells_per_side - 1); x++) {
+                const int cell = y * _cells_per_side + x;
+                for (uint32_t k = _cell_starts[cell]; k < _cell_starts[cell + 1]; k++) {
+                    glm::vec2 away = position - _positions_p[_items[k]];
+                    float distance_sq = glm::dot(away, away);
+                    if (distance_sq <= 1e-6f || distance_sq >= radius_sq) continue;
+                    push += away * (1.0f / distance_sq); // magnitude 1 / distance
+                    // bound the cost inside dense piles
+                    if (++neighbors >= max_neighbors) return push;
+                }
+            }
+        }
+        return push;
+    }
+
+private:
+    int cell_coord(float world) const {
+        int coord = static_cast<int>((world + _half_extent) / _cell_size);
+        return std::clamp(coord, 0, _cells_per_side - 1);
+    }
+    uint32_t cell_index(const glm::vec2& position) const {
+        return cell_coord(position.y) * _cells_per_side + cell_coord(position.x);
+    }
+
+    std::unique_ptr<uint32_t[]> _cell_starts;
+    std::unique_ptr<uint32_t[]> _items;
+    std::unique_ptr<uint32_t[]> _item_cells;
+    const glm::vec2* _positions_p = nullptr;
+    float _half_extent = 100.0f;
+    float _cell_size = 1.0f;
+    int _cells_per_side = 0;
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// linear allocator for temporaries that live at most until the next reset, usually one frame
+// allocating is a pointer bump and freeing does nothing, reset() drops everything at once
+// it is a memory_resource itself, so std::pmr containers can allocate from it
+// anything that does not fit goes to the heap until the next reset, which grows the buffer to fit
+struct FrameArena : std::pmr::memory_resource {
+    static constexpr size_t default_capacity = 256 * 1024;
+
+    void init(size_t capacity = default_capacity) {
+        _buffer_p = std::make_unique<std::byte[]>(capacity);
+        _capacity = capacity;
+        _used = 0;
+    }
+    void destroy() {
+        reset();
+        _buffer_p.reset();
+        _capacity = 0;
+    }
+
+    auto allocate_bytes(size_t bytes, size_t alignment = alignof(std::max_align_t)) -> void* {
+        // align the address, not the offset, the buffer itself is only aligned for max_align_t
+        uintptr_t base = reinterpret_cast<uintptr_t>(_buffer_p.get());
+        size_t offset = ((base + _used + alignment - 1) & ~(alignment - 1)) - base;
+        if (offset + bytes <= _capacity) {
+            _used = offset + bytes;
+            return _buffer_p.get() + offset;
+        }
+        // count it as if it had fit, so the next reset knows how big the buffer has to be
+        _used = offset + bytes;
+        _overflow_count++;
+        void* memory_p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        _overflow.push_back({ memory_p, bytes, alignment });
+        return memory_p;
+    }
+    // uninitialized storage, only for types that need no destructor
+    template<typename T>
+    auto allocate_array(size_t count) -> std::span<T> {
+        static_assert(std::is_trivially_destructible_v<T>, "the arena never runs destructors");
+        return { static_cast<T*>(allocate_bytes(count * sizeof(T), alignof(T))), count };
+    }
+
+    // everything allocated since the last reset is gone, returns how many bytes that was
+    auto reset() -> size_t {
+        size_t used = _used;
+        _last_frame_bytes = used;
+        _high_water = std::max(_high_water, used);
+        for (const Overflow& overflow: _overflow) std::pmr::new_delete_resource()->deallocate(overflow.memory_p, overflow.bytes, overflow.alignment);
+        _overflow.clear();
+        // nothing points into the buffer anymore, so it can be replaced by one that fits
+        if (used > _capacity) init(std::max(used + used / 2, default_capacity));
+        _used = 0;
+        return used;
+    }
+
+    auto used() const -> size_t { return _used; }
+    auto capacity() const -> size_t { return _capacity; }
+    auto last_frame_bytes() const -> size_t { return _last_frame_bytes; }
+    auto high_water() const -> size_t { return _high_water; }
+    auto overflow_count() const -> uint32_t { return _overflow_count; }
+
+    // one per thread for worker jobs, starts empty and grows on its first reset
+    static auto for_thread() -> FrameArena& {
+        thread_local FrameArena arena;
+        return arena;
+    }
+    // largest single job footprint on any worker, updated by reset_thread()
+    static auto thread_high_water() -> std::atomic<size_t>& {
+        static std::atomic<size_t> bytes = 0;
+        return bytes;
+    }
+    static void reset_thread() {
+        size_t used = for_thread().reset();
+        std::atomic<size_t>& high_water = thread_high_water();
+        size_t previous = high_water.load(std::memory_order_relaxed);
+        while (used > previous && !high_water.compare_exchange_weak(previous, used, std::memory_order_relaxed)) {}
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override { return allocate_bytes(bytes, alignment); }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    struct Overflow {
+        void* memory_p;
+        size_t bytes;
+        size_t alignment;
+    };
+    std::unique_ptr<std::byte[]> _buffer_p;
+    size_t _capacity = 0;
+    size_t _used = 0;
+    size_t _last_frame_bytes = 0;
+    size_t _high_water = 0;
+    uint32_t _overflow_count = 0;
+    std::vector<Overflow> _overflow;
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <chrono>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
+#include <glbinding/gl46core/gl.h>
+#include <SDL3/SDL_video.h>
+#include <fmt/base.h>
+#include "input.hpp"
+using namespace gl46core;
+
+// presentation and frame rate control, trades smoothness against input latency
+// a frame is wait() (limiter, then late input sampling), simulation and rendering, then present()
+struct FramePacer {
+    enum class Mode { eVsync, eAdaptiveVsync, eUncapped };
+    using Clock = std::chrono::steady_clock;
+
+    // FRAME_PACING (vsync, adaptive or uncapped), FPS_LIMIT and GPU_SYNC override the given settings
+    void init(SDL_Window* window_p, Mode mode, double fps_limit) {
+        _window_p = window_p;
+        if (const char* mode_p = std::getenv("FRAME_PACING")) {
+            std::string_view name = mode_p;
+            if (name == "vsync") mode = Mode::eVsync;
+            else if (name == "adaptive") mode = Mode::eAdaptiveVsync;
+            else if (name == "uncapped") mode = Mode::eUncapped;
+            else fmt::println("Unknown frame pacing mode: {}", name);
+        }
+        if (const char* limit_p = std::getenv("FPS_LIMIT")) fps_limit = std::strtod(limit_p, nullptr);
+        if (std::getenv("GPU_SYNC") != nullptr) _gpu_sync = true;
+        set_mode(mode);
+        set_limit(fps_limit);
+        _next_frame = Clock::now();
+        _last_present = _next_frame;
+    }
+
+    void set_mode(Mode mode) {
+        _mode = mode;
+        int interval = mode == Mode::eVsync ? 1 : mode == Mode::eAdaptiveVsync ? -1 : 0;
+        // not every driver can tear late frames, plain vsync is the closest
+        if (!SDL_GL_SetSwapInterval(interval) && mode == Mode::eAdaptiveVsync) {
+            fmt::println("Adaptive vsync not supported, using vsync");
+            _mode = Mode::eVsync;
+            SDL_GL_SetSwapInterval(1);
+        }
+        const SDL_DisplayMode* display_mode_p = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(_window_p));
+        _refresh_rate = display_mode_p != nullptr && display_mode_p->refresh_rate > 0.0f ? display_mode_p->refresh_rate : 60.0f;
+    }
+    // frames per second, 0 turns the limiter off
+    void set_limit(double fps) {
+        _period = fps > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps)) : Clock::duration::zero();
+    }
+
+    // block until the limiter allows the next frame, then sample input as late as possible
+    void wait() {
+        Clock::time_point start = Clock::now();
+        if (_period > Clock::duration::zero()) {
+            _next_frame += _period;
+            // more than a frame behind, start over instead of rushing to catch up
+            if (_next_frame < start) _next_frame = start;
+            // sleeping overshoots by up to a scheduler tick, so wake early and spin the rest
+            if (_next_frame - _spin > start) std::this_thread::sleep_until(_next_frame - _spin);
+            while (Clock::now() < _next_frame) {}
+        }
+        _input_time = Clock::now();
+        _wait_ms = std::chrono::duration<float, std::milli>(_input_time - start).count();
+        if (_late_input) Input::sample();
+        _input_ms = std::chrono::duration<float, std::milli>(Clock::now() - _input_time).count();
+    }
+
+    // swap and estimate how long the sampled input took to reach the screen
+    void present() {
+        SDL_GL_SwapWindow(_window_p);
+        // waiting for the gpu keeps the driver from queueing frames ahead, at some cost in throughput
+        if (_gpu_sync) glFinish();
+        Clock::time_point now = Clock::now();
+        float latency_ms = std::chrono::duration<float, std::milli>(now - _input_time).count();
+        // a synced swap still waits for scanout, half a refresh on average
+        if (_mode != Mode::eUncapped) latency_ms += 500.0f / _refresh_rate;
+        _latency_ms = _latency_ms == 0.0f ? latency_ms : _latency_ms * 0.9f + latency_ms * 0.1f;
+        _frame_ms = std::chrono::duration<float, std::milli>(now - _last_present).count();
+        _last_present = now;
+    }
+
+    static auto mode_name(Mode mode) -> const char* {
+        switch (mode) {
+            case Mode::eVsync: return "vsync";
+            case Mode::eAdaptiveVsync: return "adaptive vsync";
+            case Mode::eUncapped: return "uncapped";
+        }
+        return "unknown";
+    }
+
+    Mode _mode = Mode::eVsync;
+    bool _late_input = true; // sample input after the limiter instead of at event dispatch
+    bool _gpu_sync = false; // glFinish after every swap
+    Clock::duration _spin = std::chrono::microseconds(1500); // limiter busy waits this long at the end
+    // smoothed input to swap latency and the last frame's timings
+    float _latency_ms = 0.0f;
+    float _frame_ms = 0.0f;
+    float _wait_ms = 0.0f;
+    float _input_ms = 0.0f; // late input sampling
+
+private:
+    SDL_Window* _window_p = nullptr;
+    float _refresh_rate = 60.0f;
+    Clock::duration _period = Clock::duration::zero();
+    Clock::time_point _next_frame;
+    Clock::time_point _input_time;
+    Clock::time_point _last_present;
+};
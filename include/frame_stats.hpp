@@ -0,0 +1,182 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <fmt/base.h>
+#include <fmt/format.h>
+#include "profiler.hpp"
+
+// frame times of the last frame_capacity frames, split into the phases of a frame
+// percentiles and the histogram are only computed when asked for, recording is a few adds
+// gpu times of the render phases arrive a few frames late and are filled in afterwards
+struct FrameStats {
+    enum class Phase : uint8_t { eInput, eSimulation, eCollisions, eShadows, eColor, eUI, eSwap, eCount };
+    static constexpr size_t phase_count = static_cast<size_t>(Phase::eCount);
+    static constexpr std::array<const char*, phase_count> phase_names = { "input", "simulation", "collisions", "shadows", "color", "ui", "swap" };
+    static constexpr std::array<bool, phase_count> gpu_phases = { false, false, false, true, true, true, false }; // phases with gpu work
+    static constexpr uint32_t frame_capacity = 512;
+    static constexpr uint32_t histogram_buckets = 40; // 1 ms each, the last one collects everything slower
+    using Clock = std::chrono::steady_clock;
+
+    struct Frame {
+        float total_ms; // present to present
+        std::array<float, phase_count> phase_ms; // exclusive, nested phases are not counted twice
+        std::array<float, phase_count> gpu_ms;
+        bool gpu_valid; // gpu times have been read back
+    };
+    struct Summary {
+        uint32_t frames;
+        float p50, p95, p99, max, mean;
+        std::array<float, phase_count> phase_mean_ms;
+        std::array<float, phase_count> gpu_mean_ms; // over the frames with gpu times
+    };
+
+    // times a phase until the end of the enclosing block, time spent in nested scopes goes to their phase
+    // every phase is also a profiler zone
+    struct Scope {
+        Scope(FrameStats& stats, Phase phase) : _zone(phase_names[static_cast<size_t>(phase)]), _stats(stats), _parent_p(stats._active_p), _start(Clock::now()), _phase(phase) { stats._active_p = this; }
+        ~Scope() {
+            float ms = std::chrono::duration<float, std::milli>(Clock::now() - _start).count();
+            _stats._active_p = _parent_p;
+            if (_parent_p != nullptr) _parent_p->_child_ms += ms;
+            _stats.add(_phase, ms - _child_ms);
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Profiler::Zone _zone;
+        FrameStats& _stats;
+        Scope* _parent_p;
+        Clock::time_point _start;
+        Phase _phase;
+        float _child_ms = 0.0f;
+    };
+
+    void add(Phase phase, float ms) { _current.phase_ms[static_cast<size_t>(phase)] += ms; }
+    void end_frame(float total_ms) {
+        _current.total_ms = total_ms;
+        _frames[_head] = _current;
+        _head = (_head + 1) % frame_capacity;
+        _count = std::min(_count + 1, frame_capacity);
+        _current = {};
+        _frame_number++;
+    }
+    // number of the frame being recorded, counts up from 0
+    auto frame_number() const -> uint64_t { return _frame_number; }
+    // ignored once the frame has dropped out of the ring
+    void set_gpu(uint64_t frame_number, const std::array<float, phase_count>& gpu_ms) {
+        if (frame_number >= _frame_number || _frame_number - frame_number > _count) return;
+        Frame& frame = _frames[frame_number % frame_capacity];
+        frame.gpu_ms = gpu_ms;
+        frame.gpu_valid = true;
+    }
+
+    // oldest first
+    auto frame(uint32_t index) const -> const Frame& { return _frames[(_head + frame_capacity - _count + index) % frame_capacity]; }
+    auto count() const -> uint32_t { return _count; }
+    // for plotting straight from the ring, the oldest frame sits at this index once it is full
+    auto oldest() const -> uint32_t { return _count < frame_capacity ? 0 : _head; }
+    auto frames() const -> const std::array<Frame, frame_capacity>& { return _frames; }
+
+    // percentiles over the recorded frames, also refreshes the histogram
+    void summarize() {
+        Summary& summary = _summary;
+        summary = {};
+        summary.frames = _count;
+        _histogram.fill(0.0f);
+        if (_count == 0) return;
+        uint32_t gpu_count = 0;
+        for (uint32_t i = 0; i < _count; i++) {
+            const Frame& recorded = frame(i);
+            _sorted[i] = recorded.total_ms;
+            summary.mean += recorded.total_ms;
+            for (size_t phase = 0; phase < phase_count; phase++) summary.phase_mean_ms[phase] += recorded.phase_ms[phase];
+            if (recorded.gpu_valid) {
+                gpu_count++;
+                for (size_t phase = 0; phase < phase_count; phase++) summary.gpu_mean_ms[phase] += recorded.gpu_ms[phase];
+            }
+            uint32_t bucket = std::min(static_cast<uint32_t>(std::max(recorded.total_ms, 0.0f)), histogram_buckets - 1);
+            _histogram[bucket] += 1.0f;
+        }
+        summary.mean /= _count;
+        for (float& phase_ms: summary.phase_mean_ms) phase_ms /= _count;
+        if (gpu_count > 0) for (float& gpu_ms: summary.gpu_mean_ms) gpu_ms /= gpu_count;
+        // each nth_element only has to look at the part above the previous percentile
+        auto percentile = [&](float fraction, uint32_t from) {
+            uint32_t index = std::min(static_cast<uint32_t>(fraction * _count), _count - 1);
+            std::nth_element(_sorted.begin() + from, _sorted.begin() + index, _sorted.begin() + _count);
+            return index;
+        };
+        uint32_t p50 = percentile(0.50f, 0);
+        uint32_t p95 = percentile(0.95f, p50);
+        uint32_t p99 = percentile(0.99f, p95);
+        summary.p50 = _sorted[p50];
+        summary.p95 = _sorted[p95];
+        summary.p99 = _sorted[p99];
+        summary.max = *std::max_element(_sorted.begin() + p99, _sorted.begin() + _count);
+    }
+    auto summary() const -> const Summary& { return _summary; }
+    auto histogram() const -> const std::array<float, histogram_buckets>& { return _histogram; }
+
+    bool write_csv(const std::string& path) const {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            fmt::println("Failed to write frame times: {}", path);
+            return false;
+        }
+        file << "frame,total_ms";
+        for (const char* name: phase_names) file << ',' << name << "_ms";
+        for (size_t phase = 0; phase < phase_count; phase++) if (gpu_phases[phase]) file << ",gpu_" << phase_names[phase] << "_ms";
+        file << '\n';
+        for (uint32_t i = 0; i < _count; i++) {
+            const Frame& recorded = frame(i);
+            file << fmt::format("{},{:.3f}", i, recorded.total_ms);
+            for (float phase_ms: recorded.phase_ms) file << fmt::format(",{:.3f}", phase_ms);
+            // frames without gpu times leave the columns empty
+            for (size_t phase = 0; phase < phase_count; phase++) {
+                if (!gpu_phases[phase]) continue;
+                if (recorded.gpu_valid) file << fmt::format(",{:.3f}", recorded.gpu_ms[phase]);
+                else file << ',';
+            }
+            file << '\n';
+        }
+        return true;
+    }
+    bool write_json(const std::string& path) const {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            fmt::println("Failed to write frame times: {}", path);
+            return false;
+        }
+        const Summary& summary = _summary;
+        file << fmt::format("{{\n  \"summary\": {{ \"frames\": {}, \"p50_ms\": {:.3f}, \"p95_ms\": {:.3f}, \"p99_ms\": {:.3f}, \"max_ms\": {:.3f}, \"mean_ms\": {:.3f} }},\n",
+            summary.frames, summary.p50, summary.p95, summary.p99, summary.max, summary.mean);
+        file << "  \"frames\": [\n";
+        for (uint32_t i = 0; i < _count; i++) {
+            const Frame& recorded = frame(i);
+            file << fmt::format("    {{ \"total_ms\": {:.3f}", recorded.total_ms);
+            for (size_t phase = 0; phase < phase_count; phase++) file << fmt::format(", \"{}_ms\": {:.3f}", phase_names[phase], recorded.phase_ms[phase]);
+            for (size_t phase = 0; phase < phase_count && recorded.gpu_valid; phase++) {
+                if (gpu_phases[phase]) file << fmt::format(", \"gpu_{}_ms\": {:.3f}", phase_names[phase], recorded.gpu_ms[phase]);
+            }
+            file << (i + 1 < _count ? " },\n" : " }\n");
+        }
+        file << "  ]\n}\n";
+        return true;
+    }
+
+private:
+    std::array<Frame, frame_capacity> _frames = {};
+    uint32_t _head = 0;
+    uint32_t _count = 0;
+    uint64_t _frame_number = 0;
+    Frame _current = {};
+    Scope* _active_p = nullptr;
+    Summary _summary = {};
+    std::array<float, frame_capacity> _sorted = {}; // scratch for the percentiles
+    std::array<float, histogram_buckets> _histogram = {};
+};
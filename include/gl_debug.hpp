@@ -0,0 +1,130 @@
+#pragma once
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <glbinding/gl46core/gl.h>
+#include <fmt/base.h>
+using namespace gl46core;
+
+// the build picks a default, 0 off, 1 asynchronous, 2 synchronous (see GL_DEBUG in CMakeLists.txt)
+#ifndef GL_DEBUG_MODE
+    #ifdef NDEBUG
+        #define GL_DEBUG_MODE 0
+    #else
+        #define GL_DEBUG_MODE 2
+    #endif
+#endif
+
+// driver debug output through KHR_debug, plus object labels and debug groups for captures
+// synchronous reports at the offending call, asynchronous costs less but reports later and from any thread,
+// off creates a context without the debug flag and makes labels and groups no-ops
+namespace GlDebug {
+    enum class Mode { eOff, eAsync, eSync };
+    static constexpr uint32_t max_messages = 20; // printed, later ones are only counted
+
+    struct Data {
+        Mode mode = static_cast<Mode>(GL_DEBUG_MODE);
+        std::atomic<uint32_t> messages = 0;
+
+        static Data& get() {
+            static Data instance;
+            return instance;
+        }
+    };
+
+    inline auto mode() -> Mode { return Data::get().mode; }
+    inline bool enabled() { return mode() != Mode::eOff; }
+    inline auto mode_name(Mode mode) -> const char* {
+        switch (mode) {
+            case Mode::eOff: return "off";
+            case Mode::eAsync: return "async";
+            case Mode::eSync: return "sync";
+        }
+        return "unknown";
+    }
+
+    // GL_DEBUG (off, async or sync) overrides the build default, read before the context is created
+    inline void select_mode() {
+        const char* mode_p = std::getenv("GL_DEBUG");
+        if (mode_p == nullptr) return;
+        std::string_view name = mode_p;
+        if (name == "off") Data::get().mode = Mode::eOff;
+        else if (name == "async") Data::get().mode = Mode::eAsync;
+        else if (name == "sync") Data::get().mode = Mode::eSync;
+        else fmt::println("Unknown GL debug mode: {}", name);
+    }
+
+    inline auto source_name(GLenum source) -> const char* {
+        switch (source) {
+            case GL_DEBUG_SOURCE_API: return "api";
+            case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "window system";
+            case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+            case GL_DEBUG_SOURCE_THIRD_PARTY: return "third party";
+            case GL_DEBUG_SOURCE_APPLICATION: return "application";
+            default: return "other";
+        }
+    }
+    inline auto type_name(GLenum type) -> const char* {
+        switch (type) {
+            case GL_DEBUG_TYPE_ERROR: return "error";
+            case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+            case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+            case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+            case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+            case GL_DEBUG_TYPE_MARKER: return "marker";
+            default: return "other";
+        }
+    }
+    inline auto severity_name(GLenum severity) -> const char* {
+        switch (severity) {
+            case GL_DEBUG_SEVERITY_HIGH: return "high";
+            case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+            case GL_DEBUG_SEVERITY_LOW: return "low";
+            default: return "notification";
+        }
+    }
+
+    // may run on a driver thread in async mode
+    inline void callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei, const GLchar* message_p, const void*) {
+        uint32_t count = ++Data::get().messages;
+        if (count > max_messages) {
+            if (count == max_messages + 1) fmt::println("Too many OpenGL debug messages");
+            return;
+        }
+        fmt::println("OpenGL {} {} ({}, {}): {}", source_name(source), type_name(type), severity_name(severity), id, message_p);
+    }
+
+    // after the function pointers are loaded, needs a debug context for anything but off
+    inline void init() {
+        if (!enabled()) return;
+        glEnable(GL_DEBUG_OUTPUT);
+        if (mode() == Mode::eSync) glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        glDebugMessageCallback(callback, nullptr);
+        // notifications are mostly drivers announcing buffer placement, and our own groups
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+        fmt::println("OpenGL debug output: {}", mode_name(mode()));
+    }
+    inline auto messages() -> uint32_t { return Data::get().messages.load(std::memory_order_relaxed); }
+
+    // name shown for the object in capture tools and debug messages
+    inline void label(GLenum identifier, GLuint name, const std::string& label) {
+        if (!enabled() || name == 0) return;
+        glObjectLabel(identifier, name, static_cast<GLsizei>(label.size()), label.c_str());
+    }
+
+    // groups the commands of the enclosing block under a name in capture tools
+    struct Group {
+        Group(const char* name_p) : _active(enabled()) {
+            if (_active) glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name_p);
+        }
+        ~Group() {
+            if (_active) glPopDebugGroup();
+        }
+        Group(const Group&) = delete;
+        Group& operator=(const Group&) = delete;
+
+    private:
+        bool _active;
+    };
+}
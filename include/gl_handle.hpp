@@ -0,0 +1,77 @@
+#pragma once
+#include <source_location>
+#include <utility>
+#include <glbinding/gl46core/gl.h>
+#include "gl_resources.hpp"
+using namespace gl46core;
+
+// non-owning reference to a gl object, for handing it to code that only uses it
+template<GlResources::Type type>
+struct GlView {
+    GLuint name = 0;
+
+    operator GLuint() const { return name; }
+};
+
+// owns one gl object and deletes it on reset() or destruction, moves but never copies,
+// so every object has exactly one owner and is deleted exactly once
+// converts to its name for gl calls, which never take ownership
+// owners have to be reset while the context is alive, the engine destroys everything before the window
+template<GlResources::Type type>
+struct GlHandle {
+    GlHandle() = default;
+    ~GlHandle() { reset(); }
+    GlHandle(GlHandle&& other) noexcept : _name(std::exchange(other._name, 0)) {}
+    GlHandle& operator=(GlHandle&& other) noexcept {
+        if (this != &other) {
+            reset();
+            _name = std::exchange(other._name, 0);
+        }
+        return *this;
+    }
+    GlHandle(const GlHandle&) = delete;
+    GlHandle& operator=(const GlHandle&) = delete;
+
+    // creates and registers the object, target is only used by textures and queries
+    static auto create(const char* owner_p, size_t bytes = 0, GLenum target = GL_NONE, std::source_location site = std::source_location::current()) -> GlHandle {
+        GlHandle handle;
+        if constexpr (type == GlResources::Type::eBuffer) glCreateBuffers(1, &handle._name);
+        else if constexpr (type == GlResources::Type::eTexture) glCreateTextures(target, 1, &handle._name);
+        else if constexpr (type == GlResources::Type::eVertexArray) glCreateVertexArrays(1, &handle._name);
+        else if constexpr (type == GlResources::Type::eFramebuffer) glCreateFramebuffers(1, &handle._name);
+        else if constexpr (type == GlResources::Type::eProgram) handle._name = glCreateProgram();
+        else if constexpr (type == GlResources::Type::eQuery) glCreateQueries(target, 1, &handle._name);
+        GlResources::created(type, handle._name, owner_p, bytes, site);
+        return handle;
+    }
+
+    void reset() {
+        if (_name == 0) return;
+        GlResources::deleted(type, _name);
+        if constexpr (type == GlResources::Type::eBuffer) glDeleteBuffers(1, &_name);
+        else if constexpr (type == GlResources::Type::eTexture) glDeleteTextures(1, &_name);
+        else if constexpr (type == GlResources::Type::eVertexArray) glDeleteVertexArrays(1, &_name);
+        else if constexpr (type == GlResources::Type::eFramebuffer) glDeleteFramebuffers(1, &_name);
+        else if constexpr (type == GlResources::Type::eProgram) glDeleteProgram(_name);
+        else if constexpr (type == GlResources::Type::eQuery) glDeleteQueries(1, &_name);
+        _name = 0;
+    }
+
+    auto get() const -> GLuint { return _name; }
+    auto view() const -> GlView<type> { return { _name }; }
+    operator GLuint() const { return _name; }
+    operator GlView<type>() const { return view(); }
+    explicit operator bool() const { return _name != 0; }
+
+private:
+    GLuint _name = 0;
+};
+
+using GlBuffer = GlHandle<GlResources::Type::eBuffer>;
+using GlTexture = GlHandle<GlResources::Type::eTexture>;
+using GlVertexArray = GlHandle<GlResources::Type::eVertexArray>;
+using GlFramebuffer = GlHandle<GlResources::Type::eFramebuffer>;
+using GlProgram = GlHandle<GlResources::Type::eProgram>;
+using GlQuery = GlHandle<GlResources::Type::eQuery>;
+using GlFramebufferView = GlView<GlResources::Type::eFramebuffer>;
+using GlTextureView = GlView<GlResources::Type::eTexture>;
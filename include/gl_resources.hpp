@@ -0,0 +1,165 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <source_location>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <glbinding/gl46core/gl.h>
+#include <fmt/base.h>
+using namespace gl46core;
+
+// registry of every gl object the engine creates, with its estimated size, owner and creation site
+// live counts and vram go to the debug window, whatever is still alive at shutdown is reported as a leak
+// main thread only, like every gl call
+namespace GlResources {
+    enum class Type : uint8_t { eBuffer, eTexture, eVertexArray, eFramebuffer, eProgram, eQuery, eCount };
+    static constexpr size_t type_count = static_cast<size_t>(Type::eCount);
+    static constexpr std::array<const char*, type_count> type_names = { "buffers", "textures", "vertex arrays", "framebuffers", "programs", "queries" };
+
+    struct Resource {
+        Type type;
+        GLuint name;
+        size_t bytes; // estimated vram
+        const char* owner_p; // has to outlive the resource, use string literals
+        std::source_location site;
+    };
+    struct Totals {
+        std::array<uint32_t, type_count> counts;
+        std::array<size_t, type_count> bytes;
+    };
+
+    // GL_SOAK enables the soak check, its value is the sampling interval in seconds
+    // the first sample is the baseline, taken once loading is done, later samples are compared to it
+    // leaks grow in steps with flat stretches in between, so growth does not have to be in a row:
+    // the soak fails after soak_samples samples in a row more than soak_margin above the baseline,
+    // or once the count set a new high soak_samples times
+    static constexpr uint32_t soak_samples = 6;
+    static constexpr uint32_t soak_margin = 8;
+    struct Soak {
+        bool enabled = false;
+        bool failed = false;
+        std::chrono::steady_clock::duration interval = std::chrono::seconds(10);
+        std::chrono::steady_clock::time_point next_sample;
+        bool has_baseline = false;
+        uint32_t baseline = 0;
+        uint32_t high = 0; // most objects in any sample
+        uint32_t new_highs = 0; // samples that went above every earlier one
+        uint32_t above = 0; // samples in a row above baseline + soak_margin
+    };
+
+    struct Data {
+        std::unordered_map<uint64_t, Resource> resources;
+        Totals totals = {};
+        Soak soak;
+
+        static Data& get() {
+            static Data instance;
+            return instance;
+        }
+    };
+
+    inline auto key(Type type, GLuint name) -> uint64_t { return static_cast<uint64_t>(type) << 32 | name; }
+
+    inline void created(Type type, GLuint name, const char* owner_p, size_t bytes = 0, std::source_location site = std::source_location::current()) {
+        if (name == 0) return;
+        Data& data = Data::get();
+        auto [it, inserted] = data.resources.try_emplace(key(type, name), Resource{ type, name, bytes, owner_p, site });
+        if (!inserted) {
+            fmt::println("GL {} {} registered twice, by {} and {}", type_names[static_cast<size_t>(type)], name, it->second.owner_p, owner_p);
+            return;
+        }
+        data.totals.counts[static_cast<size_t>(type)]++;
+        data.totals.bytes[static_cast<size_t>(type)] += bytes;
+    }
+    inline void deleted(Type type, GLuint name) {
+        if (name == 0) return;
+        Data& data = Data::get();
+        auto it = data.resources.find(key(type, name));
+        if (it == data.resources.end()) {
+            fmt::println("GL {} {} deleted but never created or already deleted", type_names[static_cast<size_t>(type)], name);
+            return;
+        }
+        data.totals.counts[static_cast<size_t>(type)]--;
+        data.totals.bytes[static_cast<size_t>(type)] -= it->second.bytes;
+        data.resources.erase(it);
+    }
+
+    inline auto totals() -> const Totals& { return Data::get().totals; }
+    inline auto live_count() -> uint32_t {
+        uint32_t count = 0;
+        for (uint32_t type_count: totals().counts) count += type_count;
+        return count;
+    }
+    inline auto live_bytes() -> size_t {
+        size_t bytes = 0;
+        for (size_t type_bytes: totals().bytes) bytes += type_bytes;
+        return bytes;
+    }
+
+    // every live resource, grouped by creation site and owner so a leak in a loop is one line
+    inline void print_live(const char* heading_p) {
+        Data& data = Data::get();
+        struct Group { uint32_t count; size_t bytes; };
+        std::map<std::tuple<std::string_view, uint32_t, std::string_view, Type>, Group> groups;
+        for (const auto& [key, resource]: data.resources) {
+            Group& group = groups[{ resource.site.file_name(), resource.site.line(), resource.owner_p, resource.type }];
+            group.count++;
+            group.bytes += resource.bytes;
+        }
+        fmt::println("{}: {} GL objects, {:.1f} KB", heading_p, data.resources.size(), live_bytes() / 1024.0);
+        for (const auto& [site, group]: groups) {
+            const auto& [file, line, owner, type] = site;
+            fmt::println("  {:5} {:<14} {:>10.1f} KB  {:<18} {}:{}", group.count, type_names[static_cast<size_t>(type)], group.bytes / 1024.0, owner, file, line);
+        }
+    }
+    // at shutdown, after everything was destroyed
+    inline void report_leaks() {
+        if (Data::get().resources.empty()) return;
+        print_live("GL resources leaked");
+    }
+
+    inline void init_soak() {
+        Soak& soak = Data::get().soak;
+        const char* interval_p = std::getenv("GL_SOAK");
+        if (interval_p == nullptr) return;
+        soak.enabled = true;
+        double seconds = std::strtod(interval_p, nullptr);
+        if (seconds > 0.0) soak.interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+        soak.next_sample = std::chrono::steady_clock::now() + soak.interval;
+        fmt::println("GL soak check every {:.1f} s", std::chrono::duration<double>(soak.interval).count());
+    }
+    // once per frame, cheap unless a sample is due
+    inline void update_soak() {
+        Soak& soak = Data::get().soak;
+        if (!soak.enabled || soak.failed) return;
+        auto now = std::chrono::steady_clock::now();
+        if (now < soak.next_sample) return;
+        soak.next_sample = now + soak.interval;
+        uint32_t count = live_count();
+        if (!soak.has_baseline) {
+            soak.has_baseline = true;
+            soak.baseline = count;
+            soak.high = count;
+            return;
+        }
+        if (count > soak.high) {
+            soak.high = count;
+            soak.new_highs++;
+        }
+        soak.above = count > soak.baseline + soak_margin ? soak.above + 1 : 0;
+        if (soak.above >= soak_samples) {
+            fmt::println("GL soak failed, object count stayed above {} for {} samples, now {}", soak.baseline + soak_margin, soak_samples, count);
+        }
+        else if (soak.new_highs >= soak_samples) {
+            fmt::println("GL soak failed, object count set {} new highs since the baseline of {}, now {}", soak_samples, soak.baseline, count);
+        }
+        else return;
+        soak.failed = true;
+        print_live("GL resources alive");
+    }
+    inline bool soak_failed() { return Data::get().soak.failed; }
+}
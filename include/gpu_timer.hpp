@@ -0,0 +1,112 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+#include <glbinding/gl46core/gl.h>
+#include "frame_stats.hpp"
+#include "gl_resources.hpp"
+using namespace gl46core;
+
+// gpu time of each render pass, measured with a pair of timestamp queries
+// a frame's queries are read back frames_in_flight frames later when the gpu is long done with them,
+// so reading them never stalls the pipeline
+struct GpuTimer {
+    static constexpr uint32_t max_passes = 32; // per frame
+    static constexpr uint32_t frames_in_flight = 4;
+
+    struct Pass {
+        FrameStats::Phase phase;
+        int8_t light; // shadow passes only, -1 otherwise
+        int8_t face;
+        float ms;
+    };
+
+    // times a pass until the end of the enclosing block
+    struct Scope {
+        Scope(GpuTimer& timer, FrameStats::Phase phase, int light = -1, int face = -1) : _timer(timer), _index(timer.begin(phase, light, face)) {}
+        ~Scope() { _timer.end(_index); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        GpuTimer& _timer;
+        uint32_t _index;
+    };
+
+    void init() {
+        for (Slot& slot: _slots) {
+            glCreateQueries(GL_TIMESTAMP, static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+            for (GLuint query: slot.queries) GlResources::created(GlResources::Type::eQuery, query, "gpu timer");
+        }
+    }
+    void destroy() {
+        for (Slot& slot: _slots) {
+            for (GLuint query: slot.queries) GlResources::deleted(GlResources::Type::eQuery, query);
+            glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+            slot = {};
+        }
+    }
+
+    // reuse the oldest slot, its results are handed to the frame they were measured in
+    void begin_frame(uint64_t frame_number, FrameStats& stats) {
+        _current = (_current + 1) % frames_in_flight;
+        Slot& slot = _slots[_current];
+        if (slot.count > 0) collect(slot, stats);
+        slot.count = 0;
+        slot.frame_number = frame_number;
+    }
+    // returns what end() needs, passes beyond max_passes are not timed
+    auto begin(FrameStats::Phase phase, int light = -1, int face = -1) -> uint32_t {
+        Slot& slot = _slots[_current];
+        if (slot.count == max_passes) return max_passes;
+        uint32_t index = slot.count++;
+        slot.passes[index] = { phase, static_cast<int8_t>(light), static_cast<int8_t>(face), 0.0f };
+        glQueryCounter(slot.queries[index * 2], GL_TIMESTAMP);
+        return index;
+    }
+    void end(uint32_t index) {
+        if (index == max_passes) return;
+        glQueryCounter(_slots[_current].queries[index * 2 + 1], GL_TIMESTAMP);
+    }
+
+    // passes of the latest frame that was read back
+    auto passes() const -> std::span<const Pass> { return std::span<const Pass>(_collected.data(), _collected_count); }
+    // frames whose queries were still pending when their slot came around again
+    auto skipped() const -> uint32_t { return _skipped; }
+
+private:
+    struct Slot {
+        std::array<GLuint, max_passes * 2> queries = {};
+        std::array<Pass, max_passes> passes = {};
+        uint32_t count = 0;
+        uint64_t frame_number = 0;
+    };
+
+    void collect(Slot& slot, FrameStats& stats) {
+        // the last query finishes last, if even that is not done the driver is far behind, skip rather than wait
+        GLint available = 0;
+        glGetQueryObjectiv(slot.queries[slot.count * 2 - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == 0) {
+            _skipped++;
+            return;
+        }
+        std::array<float, FrameStats::phase_count> phase_ms = {};
+        for (uint32_t i = 0; i < slot.count; i++) {
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(slot.queries[i * 2], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(slot.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+            Pass& pass = slot.passes[i];
+            pass.ms = end > begin ? static_cast<float>(end - begin) / 1000000.0f : 0.0f;
+            phase_ms[static_cast<size_t>(pass.phase)] += pass.ms;
+        }
+        stats.set_gpu(slot.frame_number, phase_ms);
+        _collected = slot.passes;
+        _collected_count = slot.count;
+    }
+
+    std::array<Slot, frames_in_flight> _slots = {};
+    uint32_t _current = 0;
+    std::array<Pass, max_passes> _collected = {};
+    uint32_t _collected_count = 0;
+    uint32_t _skipped = 0;
+};
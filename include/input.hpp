@@ -1,8 +1,12 @@
 #pragma once
+#include <array>
+#include <bitset>
 #include <cctype>
-#include <set>
 #include <cstdint>
 #include <SDL3/SDL_events.h>
+#include <SDL3/SDL_keyboard.h>
+#include <SDL3/SDL_mouse.h>
+#include <SDL3/SDL_timer.h>
 // conditional includes in case imgui is available
 #if __has_include(<imgui.h>)
 #   include <imgui.h>
@@ -14,42 +18,66 @@
 #endif
 
 namespace Input {
+	// one input change, in the order it happened
+	struct Event {
+		enum class Type : uint8_t { eKeyDown, eKeyUp, eButtonDown, eButtonUp, eMotion };
+		Uint64 timestamp; // SDL event time in nanoseconds
+		Type type;
+		uint16_t code; // scancode for keys, button id for mouse buttons
+		float x, y; // mouse position, relative movement for motion events
+	};
+
 	// data storage for internal use only
+	// fixed size so that registering and flushing never allocates
 	struct Data {
 		auto static get() noexcept -> Data& { 
             static Data instance;
             return instance;
         }
-		std::set<SDL_Keycode> keys_pressed, keys_down, keys_released;
-		std::set<uint8_t> buttons_pressed, buttons_down, buttons_released;
+		static constexpr uint32_t event_capacity = 256; // power of two
+		std::bitset<SDL_SCANCODE_COUNT> keys_pressed, keys_down, keys_released;
+		std::bitset<32> buttons_pressed, buttons_down, buttons_released;
 		float x, y;
 		float dx, dy;
 		bool mouse_captured;
+		// ring of timestamped events, the oldest ones are overwritten when a frame has too many
+		std::array<Event, event_capacity> events;
+		uint32_t event_head; // total events ever registered
+		uint32_t frame_start; // event_head at the last flush
 	};
 
+	// the physical key that produces this keycode on the current layout
+	auto static inline scancode(SDL_Keycode code) noexcept -> SDL_Scancode { return SDL_GetScancodeFromKey(code, nullptr); }
+
 	struct Keys {
 		// check if key was pressed in this frame
-		bool static inline pressed(char character) noexcept { return Data::get().keys_pressed.contains(std::tolower(character)); }
+		bool static inline pressed(char character) noexcept { return pressed(static_cast<SDL_Keycode>(std::tolower(character))); }
 		// check if key was pressed in this frame
-		bool static inline pressed(SDL_Keycode code) noexcept { return Data::get().keys_pressed.contains(code); }
+		bool static inline pressed(SDL_Keycode code) noexcept { return pressed(scancode(code)); }
+		// check if key was pressed in this frame
+		bool static inline pressed(SDL_Scancode code) noexcept { return Data::get().keys_pressed.test(code); }
+		// check if key is being held down
+		bool static inline down(char character) noexcept { return down(static_cast<SDL_Keycode>(std::tolower(character))); }
 		// check if key is being held down
-		bool static inline down(char character) noexcept { return Data::get().keys_down.contains(std::tolower(character)); }
+		bool static inline down(SDL_Keycode code) noexcept { return down(scancode(code)); }
 		// check if key is being held down
-		bool static inline down(SDL_Keycode code) noexcept { return Data::get().keys_down.contains(code); }
+		bool static inline down(SDL_Scancode code) noexcept { return Data::get().keys_down.test(code); }
 		// check if key was released in this frame
-		bool static inline released(char character) noexcept { return Data::get().keys_released.contains(std::tolower(character)); }
+		bool static inline released(char character) noexcept { return released(static_cast<SDL_Keycode>(std::tolower(character))); }
 		// check if key was released in this frame
-		bool static inline released(SDL_Keycode code) noexcept { return Data::get().keys_released.contains(code); }
+		bool static inline released(SDL_Keycode code) noexcept { return released(scancode(code)); }
+		// check if key was released in this frame
+		bool static inline released(SDL_Scancode code) noexcept { return Data::get().keys_released.test(code); }
     };
 	struct Mouse {
 		// button ids to make it easier to use
 		struct ids { static constexpr uint8_t left = SDL_BUTTON_LEFT, right = SDL_BUTTON_RIGHT, middle = SDL_BUTTON_MIDDLE; };
 		// check if mouse button was pressed in this frame
-		bool static inline pressed(uint8_t button_id) noexcept { return Data::get().buttons_pressed.contains(button_id); }
+		bool static inline pressed(uint8_t button_id) noexcept { return button_id < 32 && Data::get().buttons_pressed.test(button_id); }
 		// check if mouse button is being held down
-		bool static inline down(uint8_t button_id) noexcept { return Data::get().buttons_down.contains(button_id); }
+		bool static inline down(uint8_t button_id) noexcept { return button_id < 32 && Data::get().buttons_down.test(button_id); }
 		// check if mouse button was released in this frame
-		bool static inline released(uint8_t button_id) noexcept { return Data::get().buttons_released.contains(button_id); }
+		bool static inline released(uint8_t button_id) noexcept { return button_id < 32 && Data::get().buttons_released.test(button_id); }
 		// get the current mouse position in screen coordinates
 		auto static inline position() noexcept -> std::pair<float, float> { return std::pair(Data::get().x, Data::get().y); };
 		// get the change in mouse position since the last frame
@@ -57,58 +85,102 @@ namespace Input {
 		// check if mouse is captured by the window
 		bool static inline captured() noexcept { return Data::get().mouse_captured; }
 	};
+	struct Events {
+		// number of events since the last flush (at most the ring capacity)
+		auto static inline count() noexcept -> uint32_t {
+			Data& data = Data::get();
+			uint32_t count = data.event_head - data.frame_start;
+			return count < Data::event_capacity ? count : Data::event_capacity;
+		}
+		// events of this frame from oldest (0) to newest, e.g. a tap and release within one frame
+		auto static inline at(uint32_t index) noexcept -> const Event& {
+			Data& data = Data::get();
+			return data.events[(data.event_head - count() + index) & (Data::event_capacity - 1)];
+		}
+	};
 	
 	// clear single-frame events
     void static flush() noexcept {
-		Data::get().keys_pressed.clear();
-		Data::get().keys_released.clear();
-		Data::get().buttons_pressed.clear();
-		Data::get().buttons_released.clear();
-		Data::get().dx = 0;
-		Data::get().dy = 0;
+		Data& data = Data::get();
+		data.keys_pressed.reset();
+		data.keys_released.reset();
+		data.buttons_pressed.reset();
+		data.buttons_released.reset();
+		data.dx = 0;
+		data.dy = 0;
+		data.frame_start = data.event_head;
 	}
 	// clear all events (including continuous)
 	void static flush_all() noexcept {
 		flush();
-		Data::get().keys_down.clear();
-		Data::get().buttons_down.clear();
+		Data::get().keys_down.reset();
+		Data::get().buttons_down.reset();
+	}
+	void static push_event(const Event& event) noexcept {
+		Data& data = Data::get();
+		data.events[data.event_head++ & (Data::event_capacity - 1)] = event;
+	}
+	// state changes that were already seen by sample() are skipped when their event arrives
+	void static set_key(SDL_Scancode code, bool down, Uint64 timestamp) noexcept {
+		Data& data = Data::get();
+		if (code >= SDL_SCANCODE_COUNT || data.keys_down.test(code) == down) return;
+		(down ? data.keys_pressed : data.keys_released).set(code);
+		data.keys_down.set(code, down);
+		push_event({ timestamp, down ? Event::Type::eKeyDown : Event::Type::eKeyUp, static_cast<uint16_t>(code), data.x, data.y });
+	}
+	void static set_button(uint8_t button, bool down, Uint64 timestamp, float x, float y) noexcept {
+		Data& data = Data::get();
+		if (button >= 32 || data.buttons_down.test(button) == down) return;
+		(down ? data.buttons_pressed : data.buttons_released).set(button);
+		data.buttons_down.set(button, down);
+		push_event({ timestamp, down ? Event::Type::eButtonDown : Event::Type::eButtonUp, button, x, y });
 	}
 	// pass an SDL event to the input system
 	void static register_event(const SDL_Event& event) noexcept {
+		Data& data = Data::get();
 		switch (event.type) {
 			case SDL_EventType::SDL_EVENT_KEY_UP:
-				if (event.key.repeat || IMGUI_CAPTURE_KBD) return;
-				Data::get().keys_released.insert(event.key.key);
-				Data::get().keys_down.erase(event.key.key);
-				break;
 			case SDL_EventType::SDL_EVENT_KEY_DOWN:
 				if (event.key.repeat || IMGUI_CAPTURE_KBD) return;
-				Data::get().keys_pressed.insert(event.key.key);
-				Data::get().keys_down.insert(event.key.key);
+				set_key(event.key.scancode, event.type == SDL_EventType::SDL_EVENT_KEY_DOWN, event.key.timestamp);
 				break;
 			case SDL_EventType::SDL_EVENT_MOUSE_BUTTON_UP:
+			case SDL_EventType::SDL_EVENT_MOUSE_BUTTON_DOWN:
 				if (IMGUI_CAPTURE_MOUSE) return;
-				Data::get().buttons_released.insert(event.button.button);
-				Data::get().buttons_down.erase(event.button.button);
-				break;
-			case SDL_EventType::SDL_EVENT_MOUSE_BUTTON_DOWN: 
-				if (IMGUI_CAPTURE_MOUSE) return;
-				Data::get().buttons_pressed.insert(event.button.button);
-				Data::get().buttons_down.insert(event.button.button);
+				set_button(event.button.button, event.type == SDL_EventType::SDL_EVENT_MOUSE_BUTTON_DOWN, event.button.timestamp, event.button.x, event.button.y);
 				break;
 			case SDL_EventType::SDL_EVENT_MOUSE_MOTION:
 				if (IMGUI_CAPTURE_MOUSE) return;
-				Data::get().dx = event.motion.xrel; // Movimiento relativo
-				Data::get().dy = event.motion.yrel;
-				// Restablecer posición absoluta del mouse
-				float mouseX, mouseY;
-				SDL_GetMouseState(&mouseX, &mouseY);
-				Data::get().x = mouseX;
-				Data::get().y = mouseY;
+				// several motion events can arrive in one frame, the delta covers all of them
+				data.dx += event.motion.xrel;
+				data.dy += event.motion.yrel;
+				data.x = event.motion.x;
+				data.y = event.motion.y;
+				push_event({ event.motion.timestamp, Event::Type::eMotion, 0, event.motion.xrel, event.motion.yrel });
 				break;
 			default: break;
 		}
 	}
+	// read keyboard and mouse state right now instead of waiting for the events to be dispatched,
+	// used to sample input as late as possible before the simulation runs
+	void static sample() noexcept {
+		SDL_PumpEvents();
+		Data& data = Data::get();
+		Uint64 now = SDL_GetTicksNS();
+		if (!IMGUI_CAPTURE_KBD) {
+			int count = 0;
+			const bool* state_p = SDL_GetKeyboardState(&count);
+			for (int code = 0; state_p != nullptr && code < count && code < SDL_SCANCODE_COUNT; code++) {
+				set_key(static_cast<SDL_Scancode>(code), state_p[code], now);
+			}
+		}
+		if (!IMGUI_CAPTURE_MOUSE) {
+			SDL_MouseButtonFlags buttons = SDL_GetMouseState(&data.x, &data.y);
+			for (uint8_t button = SDL_BUTTON_LEFT; button <= SDL_BUTTON_X2; button++) {
+				set_button(button, buttons & (1u << (button - 1)), now, data.x, data.y);
+			}
+		}
+	}
 	// update the current capture state of the mouse
 	void static register_capture(bool captured) noexcept {
 		Data::get().mouse_captured = captured;
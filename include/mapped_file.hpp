@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// read-only memory mapping of a whole file, pages are loaded by the OS on first touch
+struct MappedFile {
+    bool open(const char* path) {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file); // the mapping keeps the file alive
+        if (mapping == nullptr) return false;
+        _data_p = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping); // the view keeps the mapping alive
+        if (_data_p == nullptr) return false;
+        _size = static_cast<size_t>(size.QuadPart);
+#else
+        int file = ::open(path, O_RDONLY);
+        if (file < 0) return false;
+        struct stat info;
+        if (fstat(file, &info) != 0 || info.st_size == 0) {
+            ::close(file);
+            return false;
+        }
+        void* data_p = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file); // the mapping keeps the file alive
+        if (data_p == MAP_FAILED) return false;
+        _data_p = static_cast<const uint8_t*>(data_p);
+        _size = static_cast<size_t>(info.st_size);
+#endif
+        return true;
+    }
+    void close() {
+        if (_data_p == nullptr) return;
+#ifdef _WIN32
+        UnmapViewOfFile(_data_p);
+#else
+        munmap(const_cast<uint8_t*>(_data_p), _size);
+#endif
+        _data_p = nullptr;
+        _size = 0;
+    }
+
+    auto data() const -> const uint8_t* { return _data_p; }
+    auto size() const -> size_t { return _size; }
+
+    // typed view at a byte offset, nullptr if it would read past the end
+    template<typename T>
+    auto at(size_t offset, size_t count = 1) const -> const T* {
+        if (offset > _size || count * sizeof(T) > _size - offset) return nullptr;
+        return reinterpret_cast<const T*>(_data_p + offset);
+    }
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            _data_p = std::exchange(other._data_p, nullptr);
+            _size = std::exchange(other._size, 0);
+        }
+        return *this;
+    }
+    ~MappedFile() { close(); }
+
+private:
+    const uint8_t* _data_p = nullptr;
+    size_t _size = 0;
+};
@@ -0,0 +1,347 @@
+#pragma once
+#include <cassert>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <type_traits>
+#include <fmt/base.h>
+#ifdef ASSIMP_FALLBACK
+    #include <assimp/Importer.hpp>
+    #include <assimp/postprocess.h>
+    #include <assimp/scene.h>
+    #include <assimp/material.h>
+#endif
+#include "files.hpp"
+#include "model_data.hpp"
+#include "obj_parser.hpp"
+
+// binary mesh cache, written next to the source model ("Shark.obj" -> "Shark.mesh")
+// layout: Header, MaterialRecord[material_count], MeshRecord[mesh_count], then the raw buffers
+namespace MeshCache {
+    // bump whenever the layout below or Mesh::Vertex changes
+    static constexpr uint32_t version = 2;
+    static constexpr char magic[4] = { 'M', 'E', 'S', 'H' };
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t vertex_size; // guards against a changed Mesh::Vertex
+        uint32_t material_count;
+        uint32_t mesh_count;
+        glm::vec3 bounds_min;
+        glm::vec3 bounds_max;
+        uint32_t padding; // keeps the mesh records 8 byte aligned
+    };
+    struct MaterialRecord {
+        float texture_contribution;
+        float specular;
+        float specular_shininess;
+        glm::vec3 ambient;
+        glm::vec3 diffuse;
+        glm::vec3 specular_color;
+        char texture_path[128];
+    };
+    struct MeshRecord {
+        uint64_t vertex_offset; // byte offsets from the start of the file
+        uint64_t index_offset;
+        uint32_t vertex_count;
+        uint32_t index_count;
+        uint32_t material_index;
+        uint32_t padding;
+    };
+    static_assert(std::is_trivially_copyable_v<Mesh::Vertex>);
+
+    inline auto cache_path(const std::string& source_path) -> std::string {
+        return std::filesystem::path(source_path).replace_extension(".mesh").generic_string();
+    }
+
+    // the cache is usable if it exists and is not older than its source
+    // a missing source is fine, builds may ship only the caches
+    inline bool is_fresh(const std::string& cache_path, const std::string& source_path) {
+        std::error_code error;
+        auto cache_time = std::filesystem::last_write_time(cache_path, error);
+        if (error) return false;
+        auto source_time = std::filesystem::last_write_time(source_path, error);
+        if (error) return true;
+        return cache_time >= source_time;
+    }
+
+    // view over a cache file in memory, every pointer stays valid as long as the FileData it was opened on
+    struct View {
+        bool open(const FileData& file, const std::string& name) {
+            if (!file) return false;
+            _data_p = file.data();
+            _size = file.size();
+            _header_p = at<Header>(0);
+            if (_header_p == nullptr
+                || std::memcmp(_header_p->magic, magic, sizeof(magic)) != 0
+                || _header_p->version != version
+                || _header_p->vertex_size != sizeof(Mesh::Vertex)) {
+                fmt::println("Outdated or broken mesh cache: {}", name);
+                close();
+                return false;
+            }
+            _materials_p = at<MaterialRecord>(sizeof(Header), _header_p->material_count);
+            _meshes_p = at<MeshRecord>(sizeof(Header) + _header_p->material_count * sizeof(MaterialRecord), _header_p->mesh_count);
+            bool valid = _materials_p != nullptr && _meshes_p != nullptr;
+            for (uint32_t i = 0; valid && i < _header_p->mesh_count; i++) {
+                valid = vertices(i) != nullptr && indices(i) != nullptr;
+            }
+            if (!valid) {
+                fmt::println("Truncated mesh cache: {}", name);
+                close();
+            }
+            return valid;
+        }
+        void close() {
+            _data_p = nullptr;
+            _size = 0;
+            _header_p = nullptr;
+            _materials_p = nullptr;
+            _meshes_p = nullptr;
+        }
+
+        auto header() const -> const Header& { return *_header_p; }
+        auto material(uint32_t i) const -> const MaterialRecord& { return _materials_p[i]; }
+        auto mesh(uint32_t i) const -> const MeshRecord& { return _meshes_p[i]; }
+        auto vertices(uint32_t i) const -> const Mesh::Vertex* {
+            return at<Mesh::Vertex>(_meshes_p[i].vertex_offset, _meshes_p[i].vertex_count);
+        }
+        auto indices(uint32_t i) const -> const uint32_t* {
+            return at<uint32_t>(_meshes_p[i].index_offset, _meshes_p[i].index_count);
+        }
+
+    private:
+        template<typename T>
+        auto at(size_t offset, size_t count = 1) const -> const T* {
+            if (offset > _size || count * sizeof(T) > _size - offset) return nullptr;
+            return reinterpret_cast<const T*>(_data_p + offset);
+        }
+
+        const uint8_t* _data_p = nullptr;
+        size_t _size = 0;
+        const Header* _header_p = nullptr;
+        const MaterialRecord* _materials_p = nullptr;
+        const MeshRecord* _meshes_p = nullptr;
+    };
+
+    inline bool write(std::ostream& file, const ModelData& data) {
+        Header header = {};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = version;
+        header.vertex_size = sizeof(Mesh::Vertex);
+        header.material_count = static_cast<uint32_t>(data.materials.size());
+        header.mesh_count = static_cast<uint32_t>(data.meshes.size());
+        header.bounds_min = data.bounds_min;
+        header.bounds_max = data.bounds_max;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        for (size_t i = 0; i < data.materials.size(); i++) {
+            const Material& material = data.materials[i];
+            MaterialRecord record = {};
+            record.texture_contribution = material._texture_contribution;
+            record.specular = material._specular;
+            record.specular_shininess = material._specular_shininess;
+            record.ambient = material._ambient;
+            record.diffuse = material._diffuse;
+            record.specular_color = material._specularColor;
+            if (i < data.texture_paths.size()) {
+                const std::string& texture_path = data.texture_paths[i];
+                if (texture_path.size() >= sizeof(record.texture_path)) {
+                    fmt::println("Texture path too long for mesh cache: {}", texture_path);
+                }
+                texture_path.copy(record.texture_path, sizeof(record.texture_path) - 1);
+            }
+            file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+
+        // buffers follow the tables back to back
+        uint64_t offset = sizeof(Header) + data.materials.size() * sizeof(MaterialRecord) + data.meshes.size() * sizeof(MeshRecord);
+        for (const auto& mesh: data.meshes) {
+            MeshRecord record = {};
+            record.vertex_count = static_cast<uint32_t>(mesh.vertices.size());
+            record.index_count = static_cast<uint32_t>(mesh.indices.size());
+            record.material_index = mesh.material_index;
+            record.vertex_offset = offset;
+            offset += mesh.vertices.size() * sizeof(Mesh::Vertex);
+            record.index_offset = offset;
+            offset += mesh.indices.size() * sizeof(uint32_t);
+            file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+        for (const auto& mesh: data.meshes) {
+            file.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(Mesh::Vertex));
+            file.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(uint32_t));
+        }
+        return static_cast<bool>(file);
+    }
+
+#ifdef ASSIMP_FALLBACK
+    // parse any other source model with assimp into the gpu layout
+    inline bool import_assimp(const std::string& model_path, ModelData& data) {
+        Assimp::Importer importer;
+
+        // flags that allow some automatic post processing of model
+        unsigned int flags = 0; // https://assimp.sourceforge.net/lib_html/postprocess_8h.html
+        flags |= aiProcess_Triangulate; // triangulate all faces if not already triangulated
+        flags |= aiProcess_GenNormals; // generate normals if they dont exist
+        flags |= aiProcess_FlipUVs; // OpenGL prefers flipped y axis
+        flags |= aiProcess_PreTransformVertices; // simplifies model load
+
+        // load the entire "scene" (may be multiple meshes, hence scene)
+        // formats that reference other files (like obj) are handled by the native parser
+        FileData file = Files::load(model_path);
+        if (!file) return false;
+        std::string extension = std::filesystem::path(model_path).extension().string();
+        const aiScene* scene_p = importer.ReadFileFromMemory(file.data(), file.size(), flags, extension.c_str() + (extension.empty() ? 0 : 1));
+        if (scene_p == nullptr) {
+            fmt::println("{}", importer.GetErrorString());
+            return false;
+        }
+
+        // create materials
+        data.materials.resize(scene_p->mNumMaterials);
+        data.texture_paths.resize(scene_p->mNumMaterials);
+        for (uint32_t i = 0; i < scene_p->mNumMaterials; i++) {
+            aiMaterial* material_p = scene_p->mMaterials[i];
+            Material& material = data.materials[i];
+
+            // load basic material properties
+            material_p->Get(AI_MATKEY_SHININESS, material._specular);
+            material_p->Get(AI_MATKEY_SHININESS_STRENGTH, material._specular_shininess);
+
+            aiColor3D color;
+
+            // Ka
+            if (material_p->Get(AI_MATKEY_COLOR_AMBIENT, color) == AI_SUCCESS) {
+                material._ambient = glm::vec3(color.r, color.g, color.b);
+            } else {
+                material._ambient = glm::vec3(0.1f);
+            }
+
+            // Kd
+            if (material_p->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS) {
+                material._diffuse = glm::vec3(color.r, color.g, color.b);
+            } else {
+                material._diffuse = glm::vec3(0.76f, 0.70f, 0.50f);
+            }
+
+            // Ks
+            if (material_p->Get(AI_MATKEY_COLOR_SPECULAR, color) == AI_SUCCESS) {
+                material._specularColor = glm::vec3(color.r, color.g, color.b);
+            } else {
+                material._specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
+            }
+
+            // Ns (Shininess)
+            if (material_p->Get(AI_MATKEY_SHININESS, material._specular_shininess) != AI_SUCCESS) {
+                material._specular_shininess = 4.0f;
+            }
+
+            // see if this should use a diffuse texture
+            if (material_p->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
+                material._texture_contribution = 1.0;
+                aiString texture_path;
+                material_p->Get(AI_MATKEY_TEXTURE(aiTextureType_DIFFUSE, 0), texture_path);
+                data.texture_paths[i] = texture_path.C_Str();
+            } else {
+                material._texture_contribution = 0.0;
+            }
+        }
+
+        // convert meshes
+        data.bounds_min = glm::vec3(std::numeric_limits<float>::max());
+        data.bounds_max = glm::vec3(std::numeric_limits<float>::lowest());
+        data.meshes.resize(scene_p->mNumMeshes);
+        for (uint32_t i = 0; i < scene_p->mNumMeshes; i++) {
+            aiMesh* mesh_p = scene_p->mMeshes[i];
+            ModelData::MeshData& mesh = data.meshes[i];
+            mesh.vertices.reserve(mesh_p->mNumVertices);
+            for (uint32_t k = 0; k < mesh_p->mNumVertices; k++) {
+                Mesh::Vertex vertex;
+                // extract positions
+                vertex.position.x = mesh_p->mVertices[k].x;
+                vertex.position.y = mesh_p->mVertices[k].y;
+                vertex.position.z = mesh_p->mVertices[k].z;
+                // extract normals
+                vertex.normal.x = mesh_p->mNormals[k].x;
+                vertex.normal.y = mesh_p->mNormals[k].y;
+                vertex.normal.z = mesh_p->mNormals[k].z;
+                // extract uv/st coords
+                if (mesh_p->HasTextureCoords(0)) {
+                    vertex.uv.s = mesh_p->mTextureCoords[0][k].x;
+                    vertex.uv.t = mesh_p->mTextureCoords[0][k].y;
+                }
+                else vertex.uv = {0, 0};
+                // extract vertex colors (if present)
+                if (mesh_p->HasVertexColors(0)) {
+                    vertex.color.r = mesh_p->mColors[0][k].r;
+                    vertex.color.g = mesh_p->mColors[0][k].g;
+                    vertex.color.b = mesh_p->mColors[0][k].b;
+                    vertex.color.a = mesh_p->mColors[0][k].a;
+                }
+                else vertex.color = {1, 1, 1, 1};
+                data.bounds_min = glm::min(data.bounds_min, vertex.position);
+                data.bounds_max = glm::max(data.bounds_max, vertex.position);
+                mesh.vertices.push_back(vertex);
+            }
+
+            mesh.indices.reserve(mesh_p->mNumFaces * 3);
+            for (uint32_t k = 0; k < mesh_p->mNumFaces; k++) {
+                const aiFace& face = mesh_p->mFaces[k];
+                assert(face.mNumIndices == 3);
+                for (uint32_t j = 0; j < face.mNumIndices; j++) {
+                    mesh.indices.push_back(face.mIndices[j]);
+                }
+            }
+            mesh.material_index = mesh_p->mMaterialIndex;
+        }
+        if (data.meshes.empty()) {
+            data.bounds_min = glm::vec3(0.0f);
+            data.bounds_max = glm::vec3(0.0f);
+        }
+        return true;
+    }
+
+#endif
+
+    inline bool write(const std::string& path, const ModelData& data) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file || !write(file, data)) {
+            fmt::println("Failed to write mesh cache: {}", path);
+            return false;
+        }
+        return true;
+    }
+
+    // obj goes through the native parser, other formats need assimp
+    // scratch_p takes the parser's temporaries, they are all freed again before this returns
+    inline bool import(const std::string& model_path, ModelData& data, std::pmr::memory_resource* scratch_p = std::pmr::get_default_resource()) {
+        std::string extension = std::filesystem::path(model_path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (extension == ".obj") {
+            ObjParser parser;
+            parser._scratch_p = scratch_p;
+            return parser.parse(model_path, data);
+        }
+#ifdef ASSIMP_FALLBACK
+        return import_assimp(model_path, data);
+#else
+        fmt::println("Unsupported model format (built without assimp): {}", model_path);
+        return false;
+#endif
+    }
+
+    // import a loose source model and (re)write its cache, used by the converter
+    inline bool convert(const std::string& source_name) {
+        ModelData data;
+        if (!import(source_name, data)) return false;
+        return write(Files::loose_path(cache_path(source_name)), data);
+    }
+}
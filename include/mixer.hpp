@@ -0,0 +1,278 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <SDL3/SDL_audio.h>
+#include <fmt/base.h>
+#include "sound_bank.hpp"
+#include "spsc_queue.hpp"
+#include "profiler.hpp"
+#include "alloc_tracker.hpp"
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+    #include <xmmintrin.h>
+    #define MIXER_SSE
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define MIXER_NEON
+#endif
+
+// one output stream for every sound effect, mixed in software on the audio thread
+// the game thread only pushes play requests into a lock-free queue, the voices belong to the audio thread
+// streamed sounds are converted chunk by chunk from their mapped file into a small ring per stream slot
+struct Mixer {
+    static constexpr uint32_t voice_count = 24;
+    static constexpr uint32_t block_frames = 256; // frames mixed per pass
+    static constexpr int channels = 2;
+    static constexpr uint32_t stream_slots = 2; // streamed sounds playing at once
+    static constexpr uint32_t ring_frames = 4096; // per stream slot, power of two
+    static constexpr uint32_t chunk_bytes = 16 * 1024; // file data converted per refill
+
+    // the format the sound bank has to decode to: float stereo at the device rate
+    static auto output_spec() -> SDL_AudioSpec {
+        SDL_AudioSpec device_spec = { SDL_AUDIO_F32, channels, 48000 };
+        SDL_GetAudioDeviceFormat(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &device_spec, nullptr);
+        return { SDL_AUDIO_F32, channels, device_spec.freq };
+    }
+
+    void init(const SoundBank& bank) {
+        _bank_p = &bank;
+        SDL_AudioSpec spec = bank.spec();
+        // the source format is set when a slot starts playing, the output is always the mixer format
+        for (Stream& stream: _streams) {
+            stream.converter_p = SDL_CreateAudioStream(&spec, &spec);
+            stream.ring.assign(ring_frames * channels, 0.0f);
+        }
+        _stream_p = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec, callback, this);
+        if (_stream_p == nullptr) {
+            fmt::println("Failed to open audio stream: {}", SDL_GetError());
+            return;
+        }
+        SDL_ResumeAudioStreamDevice(_stream_p);
+    }
+    void destroy() {
+        // closes the device as well, the callback is not called after this
+        SDL_DestroyAudioStream(_stream_p);
+        _stream_p = nullptr;
+        for (Stream& stream: _streams) {
+            SDL_DestroyAudioStream(stream.converter_p);
+            stream = {};
+        }
+        _voices = {};
+    }
+
+    // safe to call from the game thread at any rate, never blocks
+    void play(SoundId id, float gain = 1.0f) {
+        if (_stream_p == nullptr) return;
+        if (!_requests.push({ id, gain })) _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto active_voices() const -> uint32_t { return _active_voices.load(std::memory_order_relaxed); }
+    // requests that found no voice or no room in the queue
+    auto dropped() const -> uint32_t { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Request {
+        SoundId id;
+        float gain;
+    };
+    struct Voice {
+        const float* samples_p = nullptr;
+        uint32_t frames = 0;
+        uint32_t position = 0; // frames already played
+        float gain = 1.0f;
+        SoundId id = SoundId::eCount;
+        uint8_t priority = 0;
+        bool active = false;
+        int8_t stream = -1; // stream slot of streamed sounds
+    };
+    struct Stream {
+        SDL_AudioStream* converter_p = nullptr;
+        const SoundBank::Sound* sound_p = nullptr;
+        uint32_t read_offset = 0; // file bytes already handed to the converter
+        uint32_t ring_read = 0; // frames, wrap around ring_frames
+        uint32_t ring_write = 0;
+        bool in_use = false;
+        std::vector<float> ring;
+    };
+
+    // audio thread, asked for additional_amount more bytes
+    static void SDLCALL callback(void* user_p, SDL_AudioStream* stream_p, int additional_amount, int) {
+        Profiler::set_thread_name("audio");
+        Profiler::Zone zone("audio mix");
+        AllocTracker::Scope alloc_scope(AllocTracker::Subsystem::eAudio);
+        Mixer& mixer = *static_cast<Mixer*>(user_p);
+        Request request;
+        while (mixer._requests.pop(request)) mixer.start(request);
+
+        constexpr int frame_bytes = channels * sizeof(float);
+        int frames = (additional_amount + frame_bytes - 1) / frame_bytes;
+        while (frames > 0) {
+            uint32_t count = std::min<uint32_t>(frames, block_frames);
+            mixer.mix(count);
+            SDL_PutAudioStreamData(stream_p, mixer._block.data(), count * frame_bytes);
+            frames -= count;
+        }
+
+        uint32_t active = 0;
+        for (const Voice& voice: mixer._voices) active += voice.active;
+        mixer._active_voices.store(active, std::memory_order_relaxed);
+    }
+
+    void start(const Request& request) {
+        const SoundBank::Sound& sound = _bank_p->sound(request.id);
+        if (sound.frames == 0) return;
+        Voice* free_p = nullptr;
+        Voice* oldest_same_p = nullptr;
+        Voice* weakest_p = nullptr;
+        uint32_t same_count = 0;
+        for (Voice& voice: _voices) {
+            if (!voice.active) {
+                if (free_p == nullptr) free_p = &voice;
+                continue;
+            }
+            if (voice.id == request.id) {
+                same_count++;
+                if (oldest_same_p == nullptr || voice.position > oldest_same_p->position) oldest_same_p = &voice;
+            }
+            // lowest priority first, among those the one furthest along
+            if (weakest_p == nullptr || voice.priority < weakest_p->priority
+                || (voice.priority == weakest_p->priority && voice.position > weakest_p->position)) weakest_p = &voice;
+        }
+
+        // too many of this sound restarts its oldest instance, a full pool takes the weakest voice if allowed
+        Voice* target_p = free_p;
+        if (same_count >= sound.max_voices) target_p = oldest_same_p;
+        else if (target_p == nullptr && weakest_p->priority <= sound.priority) target_p = weakest_p;
+        if (target_p == nullptr) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // a replaced streamed voice hands its slot over, otherwise a free one is needed
+        int8_t stream = -1;
+        if (sound.streamed) {
+            stream = target_p->active && target_p->stream >= 0 ? target_p->stream : free_stream();
+            if (stream < 0) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        if (target_p->active && target_p->stream >= 0 && target_p->stream != stream) stop(*target_p);
+        if (stream >= 0) begin_stream(_streams[stream], sound);
+        *target_p = { sound.samples.data(), sound.frames, 0, request.gain, request.id, sound.priority, true, stream };
+    }
+    void stop(Voice& voice) {
+        if (voice.stream >= 0) _streams[voice.stream].in_use = false;
+        voice.active = false;
+        voice.stream = -1;
+    }
+
+    auto free_stream() const -> int8_t {
+        for (uint32_t i = 0; i < stream_slots; i++) {
+            if (!_streams[i].in_use && _streams[i].converter_p != nullptr) return static_cast<int8_t>(i);
+        }
+        return -1;
+    }
+    void begin_stream(Stream& stream, const SoundBank::Sound& sound) {
+        SDL_ClearAudioStream(stream.converter_p);
+        SDL_SetAudioStreamFormat(stream.converter_p, &sound.file_spec, nullptr);
+        stream.sound_p = &sound;
+        stream.read_offset = 0;
+        stream.ring_read = 0;
+        stream.ring_write = 0;
+        stream.in_use = true;
+    }
+    // tops the ring up from the mapped file, returns how many of the wanted frames are ready
+    auto refill(Stream& stream, uint32_t wanted) -> uint32_t {
+        constexpr int frame_bytes = channels * sizeof(float);
+        const SoundBank::Sound& sound = *stream.sound_p;
+        while (stream.ring_write - stream.ring_read < wanted) {
+            uint32_t offset = stream.ring_write & (ring_frames - 1);
+            uint32_t space = std::min(ring_frames - (stream.ring_write - stream.ring_read), ring_frames - offset);
+            int got = SDL_GetAudioStreamData(stream.converter_p, stream.ring.data() + offset * channels, space * frame_bytes);
+            if (got > 0) {
+                stream.ring_write += got / frame_bytes;
+                continue;
+            }
+            if (stream.read_offset >= sound.pcm_bytes) break; // converter drained, the sound is over
+            uint32_t chunk = std::min(chunk_bytes, sound.pcm_bytes - stream.read_offset);
+            if (!SDL_PutAudioStreamData(stream.converter_p, sound.pcm_p + stream.read_offset, chunk)) break;
+            stream.read_offset += chunk;
+            if (stream.read_offset == sound.pcm_bytes) SDL_FlushAudioStream(stream.converter_p);
+        }
+        return std::min(wanted, stream.ring_write - stream.ring_read);
+    }
+
+    void mix(uint32_t frames) {
+        float* out_p = _block.data();
+        std::fill_n(out_p, frames * channels, 0.0f);
+        for (Voice& voice: _voices) {
+            if (!voice.active) continue;
+            if (voice.stream >= 0) {
+                mix_stream(out_p, voice, frames);
+                continue;
+            }
+            uint32_t count = std::min(frames, voice.frames - voice.position);
+            mix_add(out_p, voice.samples_p + static_cast<size_t>(voice.position) * channels, count * channels, voice.gain);
+            voice.position += count;
+            if (voice.position >= voice.frames) voice.active = false;
+        }
+        clip(out_p, frames * channels);
+    }
+
+    void mix_stream(float* out_p, Voice& voice, uint32_t frames) {
+        Stream& stream = _streams[voice.stream];
+        uint32_t count = refill(stream, frames);
+        // the ready frames may wrap around the end of the ring
+        uint32_t offset = stream.ring_read & (ring_frames - 1);
+        uint32_t first = std::min(count, ring_frames - offset);
+        mix_add(out_p, stream.ring.data() + offset * channels, first * channels, voice.gain);
+        mix_add(out_p + first * channels, stream.ring.data(), (count - first) * channels, voice.gain);
+        stream.ring_read += count;
+        voice.position += count;
+        if (count < frames) stop(voice);
+    }
+
+    // out += in * gain, four samples at a time where the cpu allows
+    static void mix_add(float* out_p, const float* in_p, uint32_t count, float gain) {
+        uint32_t i = 0;
+#if defined(MIXER_SSE)
+        __m128 gains = _mm_set1_ps(gain);
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(out_p + i, _mm_add_ps(_mm_loadu_ps(out_p + i), _mm_mul_ps(_mm_loadu_ps(in_p + i), gains)));
+        }
+#elif defined(MIXER_NEON)
+        float32x4_t gains = vdupq_n_f32(gain);
+        for (; i + 4 <= count; i += 4) {
+            vst1q_f32(out_p + i, vmlaq_f32(vld1q_f32(out_p + i), vld1q_f32(in_p + i), gains));
+        }
+#endif
+        for (; i < count; i++) out_p[i] += in_p[i] * gain;
+    }
+    // keep overlapping sounds from wrapping around in the device conversion
+    static void clip(float* samples_p, uint32_t count) {
+        uint32_t i = 0;
+#if defined(MIXER_SSE)
+        __m128 low = _mm_set1_ps(-1.0f), high = _mm_set1_ps(1.0f);
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(samples_p + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(samples_p + i), low), high));
+        }
+#elif defined(MIXER_NEON)
+        float32x4_t low = vdupq_n_f32(-1.0f), high = vdupq_n_f32(1.0f);
+        for (; i + 4 <= count; i += 4) {
+            vst1q_f32(samples_p + i, vminq_f32(vmaxq_f32(vld1q_f32(samples_p + i), low), high));
+        }
+#endif
+        for (; i < count; i++) samples_p[i] = std::clamp(samples_p[i], -1.0f, 1.0f);
+    }
+
+    const SoundBank* _bank_p = nullptr;
+    SDL_AudioStream* _stream_p = nullptr;
+    SpscQueue<Request, 64> _requests;
+    std::array<Voice, voice_count> _voices = {};
+    std::array<Stream, stream_slots> _streams = {};
+    alignas(16) std::array<float, block_frames * channels> _block = {};
+    std::atomic<uint32_t> _active_voices = 0;
+    std::atomic<uint32_t> _dropped = 0;
+};
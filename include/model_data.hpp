@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "entities/mesh.hpp"
+#include "entities/material.hpp"
+
+// cpu side copy of an imported model in the exact layout the gpu buffers use
+struct ModelData {
+    struct MeshData {
+        std::vector<Mesh::Vertex> vertices;
+        std::vector<uint32_t> indices;
+        uint32_t material_index = 0;
+    };
+    std::vector<MeshData> meshes;
+    std::vector<Material> materials;
+    std::vector<std::string> texture_paths; // per material, relative to the model, empty if untextured
+    glm::vec3 bounds_min = glm::vec3(0.0f);
+    glm::vec3 bounds_max = glm::vec3(0.0f);
+};
@@ -0,0 +1,387 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <limits>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <fmt/base.h>
+#include <glm/glm.hpp>
+#include "files.hpp"
+#include "model_data.hpp"
+
+// streaming OBJ/MTL reader that writes straight into ModelData
+// large files are split into chunks on line boundaries and parsed on several threads,
+// the chunks are then stitched together into one mesh per material
+// scratch data lives in _scratch_p and is gone once parse() returns, only ModelData is kept
+struct ObjParser {
+    bool parse(const std::string& path, ModelData& data) {
+        FileData file = Files::load(path);
+        if (!file) return false;
+        const char* begin_p = reinterpret_cast<const char*>(file.data());
+        const char* end_p = begin_p + file.size();
+
+        // small files stay on this thread
+        size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+        size_t chunk_count = std::clamp<size_t>(file.size() / _min_chunk_bytes, 1, thread_count);
+        // the scratch resource is only safe on this thread, chunks parsed elsewhere use the heap
+        std::vector<Chunk> chunks;
+        chunks.reserve(chunk_count);
+        const char* chunk_begin_p = begin_p;
+        for (size_t i = 0; i < chunk_count; i++) {
+            chunks.emplace_back(i == 0 ? _scratch_p : std::pmr::get_default_resource());
+            const char* chunk_end_p = end_p;
+            if (i + 1 < chunk_count) {
+                chunk_end_p = next_line(begin_p + file.size() * (i + 1) / chunk_count, end_p);
+                chunk_end_p = std::max(chunk_end_p, chunk_begin_p);
+            }
+            chunks[i]._begin_p = chunk_begin_p;
+            chunks[i]._end_p = chunk_end_p;
+            chunk_begin_p = chunk_end_p;
+        }
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < chunk_count; i++) {
+            threads.emplace_back([&chunk = chunks[i]] { parse_chunk(chunk); });
+        }
+        parse_chunk(chunks[0]);
+        for (auto& thread: threads) thread.join();
+
+        // materials come from the mtl files the obj references
+        size_t separator_index = path.find_last_of('/');
+        std::string model_root = path.substr(0, separator_index + 1);
+        std::unordered_map<std::string, uint32_t> material_lookup;
+        for (const Chunk& chunk: chunks) {
+            for (const std::string& library: chunk._libraries) {
+                parse_mtl(model_root + library, data, material_lookup);
+            }
+        }
+        return assemble(path, chunks, data, material_lookup, _scratch_p);
+    }
+
+    size_t _min_chunk_bytes = 256 * 1024; // below this a thread costs more than it saves
+    std::pmr::memory_resource* _scratch_p = std::pmr::get_default_resource();
+
+private:
+    static constexpr int32_t missing = std::numeric_limits<int32_t>::min();
+    static constexpr uint32_t inherit_material = std::numeric_limits<uint32_t>::max();
+
+    // one face corner, indices are 0 based and global unless marked relative to the chunk start
+    struct Corner {
+        int32_t position, uv, normal;
+        uint8_t relative; // bit 0 position, bit 1 uv, bit 2 normal
+    };
+    struct Face {
+        uint32_t first_corner;
+        uint32_t corner_count;
+        uint32_t material; // index into the chunk's material names
+    };
+    struct Chunk {
+        Chunk(std::pmr::memory_resource* resource_p)
+            : _positions(resource_p), _uvs(resource_p), _normals(resource_p), _corners(resource_p), _faces(resource_p) {}
+
+        const char* _begin_p = nullptr;
+        const char* _end_p = nullptr;
+        std::pmr::vector<glm::vec3> _positions;
+        std::pmr::vector<glm::vec2> _uvs;
+        std::pmr::vector<glm::vec3> _normals;
+        std::pmr::vector<Corner> _corners;
+        std::pmr::vector<Face> _faces;
+        std::vector<std::string> _material_names;
+        std::vector<std::string> _libraries;
+        uint32_t _material = inherit_material; // faces before the first usemtl continue the previous chunk
+    };
+    struct VertexKey {
+        int32_t position, uv, normal;
+        bool operator==(const VertexKey& other) const {
+            return position == other.position && uv == other.uv && normal == other.normal;
+        }
+    };
+    struct VertexKeyHash {
+        size_t operator()(const VertexKey& key) const {
+            uint64_t hash = static_cast<uint32_t>(key.position);
+            hash = hash * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(key.uv);
+            hash = hash * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(key.normal);
+            return static_cast<size_t>(hash ^ (hash >> 32));
+        }
+    };
+
+    static auto next_line(const char* p, const char* end_p) -> const char* {
+        const char* newline_p = static_cast<const char*>(std::memchr(p, '\n', end_p - p));
+        return newline_p ? newline_p + 1 : end_p;
+    }
+    static void skip_spaces(const char*& p, const char* end_p) {
+        while (p < end_p && (*p == ' ' || *p == '\t')) p++;
+    }
+    static auto parse_float(const char*& p, const char* end_p) -> float {
+        skip_spaces(p, end_p);
+        if (p < end_p && *p == '+') p++; // from_chars does not accept a leading plus
+        float value = 0.0f;
+        auto result = std::from_chars(p, end_p, value);
+        p = result.ptr;
+        return value;
+    }
+    static auto parse_word(const char*& p, const char* end_p) -> std::string_view {
+        skip_spaces(p, end_p);
+        const char* word_p = p;
+        while (p < end_p && *p != ' ' && *p != '\t') p++;
+        return std::string_view(word_p, p - word_p);
+    }
+    // rest of the line without surrounding whitespace, names may contain spaces
+    static auto parse_rest(const char* p, const char* end_p) -> std::string_view {
+        skip_spaces(p, end_p);
+        while (end_p > p && (end_p[-1] == ' ' || end_p[-1] == '\t')) end_p--;
+        return std::string_view(p, end_p - p);
+    }
+    static auto parse_vec3(const char*& p, const char* end_p) -> glm::vec3 {
+        float x = parse_float(p, end_p);
+        float y = parse_float(p, end_p);
+        float z = parse_float(p, end_p);
+        return glm::vec3(x, y, z);
+    }
+
+    // obj indices are 1 based, negative ones count back from the newest element
+    static bool parse_index(const char*& p, const char* end_p, uint32_t local_count, int32_t& index, bool& relative) {
+        int32_t value = 0;
+        auto result = std::from_chars(p, end_p, value);
+        if (result.ec != std::errc() || value == 0) return false;
+        p = result.ptr;
+        relative = value < 0;
+        index = relative ? static_cast<int32_t>(local_count) + value : value - 1;
+        return true;
+    }
+    static bool parse_corner(Chunk& chunk, const char*& p, const char* end_p, Corner& corner) {
+        corner = { missing, missing, missing, 0 };
+        bool relative = false;
+        if (!parse_index(p, end_p, chunk._positions.size(), corner.position, relative)) return false;
+        corner.relative |= relative ? 1 : 0;
+        if (p < end_p && *p == '/') {
+            p++;
+            if (p < end_p && *p != '/') {
+                if (!parse_index(p, end_p, chunk._uvs.size(), corner.uv, relative)) return false;
+                corner.relative |= relative ? 2 : 0;
+            }
+            if (p < end_p && *p == '/') {
+                p++;
+                if (!parse_index(p, end_p, chunk._normals.size(), corner.normal, relative)) return false;
+                corner.relative |= relative ? 4 : 0;
+            }
+        }
+        return true;
+    }
+
+    static void parse_chunk(Chunk& chunk) {
+        const char* p = chunk._begin_p;
+        while (p < chunk._end_p) {
+            const char* line_end_p = next_line(p, chunk._end_p);
+            const char* end_p = line_end_p;
+            while (end_p > p && (end_p[-1] == '\n' || end_p[-1] == '\r')) end_p--;
+            parse_line(chunk, p, end_p);
+            p = line_end_p;
+        }
+    }
+    static void parse_line(Chunk& chunk, const char* p, const char* end_p) {
+        std::string_view keyword = parse_word(p, end_p);
+        if (keyword == "v") {
+            chunk._positions.push_back(parse_vec3(p, end_p));
+        }
+        else if (keyword == "vt") {
+            float u = parse_float(p, end_p);
+            float v = parse_float(p, end_p);
+            chunk._uvs.emplace_back(u, v);
+        }
+        else if (keyword == "vn") {
+            chunk._normals.push_back(parse_vec3(p, end_p));
+        }
+        else if (keyword == "f") {
+            Face face = { static_cast<uint32_t>(chunk._corners.size()), 0, chunk._material };
+            skip_spaces(p, end_p);
+            while (p < end_p) {
+                Corner corner;
+                if (!parse_corner(chunk, p, end_p, corner)) break;
+                chunk._corners.push_back(corner);
+                face.corner_count++;
+                skip_spaces(p, end_p);
+            }
+            if (face.corner_count >= 3) chunk._faces.push_back(face);
+            else chunk._corners.resize(face.first_corner);
+        }
+        else if (keyword == "usemtl") {
+            chunk._material = static_cast<uint32_t>(chunk._material_names.size());
+            chunk._material_names.emplace_back(parse_rest(p, end_p));
+        }
+        else if (keyword == "mtllib") {
+            chunk._libraries.emplace_back(parse_rest(p, end_p));
+        }
+        // o, g, s and comments do not matter, meshes are merged per material anyway
+    }
+
+    static void parse_mtl(const std::string& path, ModelData& data, std::unordered_map<std::string, uint32_t>& material_lookup) {
+        FileData file = Files::load(path);
+        if (!file) return;
+        const char* p = reinterpret_cast<const char*>(file.data());
+        const char* file_end_p = p + file.size();
+        Material* material_p = nullptr;
+        while (p < file_end_p) {
+            const char* line_end_p = next_line(p, file_end_p);
+            const char* end_p = line_end_p;
+            while (end_p > p && (end_p[-1] == '\n' || end_p[-1] == '\r')) end_p--;
+            std::string_view keyword = parse_word(p, end_p);
+            if (keyword == "newmtl") {
+                std::string name(parse_rest(p, end_p));
+                material_lookup[name] = static_cast<uint32_t>(data.materials.size());
+                material_p = &data.materials.emplace_back();
+                data.texture_paths.emplace_back();
+            }
+            else if (material_p != nullptr) {
+                if (keyword == "Ka") material_p->_ambient = parse_vec3(p, end_p);
+                else if (keyword == "Kd") material_p->_diffuse = parse_vec3(p, end_p);
+                else if (keyword == "Ks") material_p->_specularColor = parse_vec3(p, end_p);
+                else if (keyword == "Ns") {
+                    // same mapping the assimp path used, Ns drives both values
+                    material_p->_specular = parse_float(p, end_p);
+                    material_p->_specular_shininess = material_p->_specular;
+                }
+                else if (keyword == "map_Kd") {
+                    // options like -bm come first, the file name is the last word
+                    std::string_view rest = parse_rest(p, end_p);
+                    size_t space = rest.find_last_of(" \t");
+                    if (space != std::string_view::npos) rest.remove_prefix(space + 1);
+                    data.texture_paths.back() = std::string(rest);
+                    material_p->_texture_contribution = 1.0;
+                }
+            }
+            p = line_end_p;
+        }
+    }
+
+    static bool assemble(const std::string& path, std::vector<Chunk>& chunks, ModelData& data, const std::unordered_map<std::string, uint32_t>& material_lookup, std::pmr::memory_resource* scratch_p) {
+        // stitch the per chunk element lists together, sized up front since scratch memory is never reused
+        std::pmr::vector<glm::vec3> positions(scratch_p);
+        std::pmr::vector<glm::vec2> uvs(scratch_p);
+        std::pmr::vector<glm::vec3> normals(scratch_p);
+        size_t position_count = 0, uv_count = 0, normal_count = 0;
+        for (const Chunk& chunk: chunks) {
+            position_count += chunk._positions.size();
+            uv_count += chunk._uvs.size();
+            normal_count += chunk._normals.size();
+        }
+        positions.reserve(position_count);
+        uvs.reserve(uv_count);
+        normals.reserve(normal_count);
+        for (const Chunk& chunk: chunks) {
+            positions.insert(positions.end(), chunk._positions.begin(), chunk._positions.end());
+            uvs.insert(uvs.end(), chunk._uvs.begin(), chunk._uvs.end());
+            normals.insert(normals.end(), chunk._normals.begin(), chunk._normals.end());
+        }
+
+        uint32_t default_material = inherit_material;
+        std::pmr::vector<uint32_t> material_meshes(data.materials.size() + 1, inherit_material, scratch_p);
+        std::pmr::vector<std::pmr::unordered_map<VertexKey, uint32_t, VertexKeyHash>> vertex_lookups(scratch_p);
+        uint32_t material = inherit_material;
+        int32_t position_base = 0, uv_base = 0, normal_base = 0;
+        uint32_t broken_faces = 0;
+        std::pmr::vector<VertexKey> face_keys(scratch_p);
+        data.bounds_min = glm::vec3(std::numeric_limits<float>::max());
+        data.bounds_max = glm::vec3(std::numeric_limits<float>::lowest());
+
+        for (const Chunk& chunk: chunks) {
+            for (const Face& face: chunk._faces) {
+                // resolve the material by name, unknown names fall back to a default one
+                if (face.material != inherit_material) {
+                    auto it = material_lookup.find(chunk._material_names[face.material]);
+                    material = it != material_lookup.end() ? it->second : inherit_material;
+                }
+                if (material == inherit_material) {
+                    if (default_material == inherit_material) {
+                        default_material = static_cast<uint32_t>(data.materials.size());
+                        data.materials.emplace_back();
+                        data.texture_paths.emplace_back();
+                    }
+                    material = default_material;
+                }
+                if (material >= material_meshes.size()) material_meshes.resize(material + 1, inherit_material);
+                if (material_meshes[material] == inherit_material) {
+                    material_meshes[material] = static_cast<uint32_t>(data.meshes.size());
+                    data.meshes.emplace_back().material_index = material;
+                    vertex_lookups.emplace_back();
+                }
+                ModelData::MeshData& mesh = data.meshes[material_meshes[material]];
+                auto& vertex_lookup = vertex_lookups[material_meshes[material]];
+
+                // resolve relative indices and validate the whole face before emitting anything
+                const Corner* corners_p = &chunk._corners[face.first_corner];
+                VertexKey keys[3];
+                bool valid = true;
+                bool has_normals = true;
+                face_keys.resize(face.corner_count);
+                for (uint32_t i = 0; i < face.corner_count; i++) {
+                    const Corner& corner = corners_p[i];
+                    VertexKey& key = face_keys[i];
+                    key.position = corner.position + ((corner.relative & 1) ? position_base : 0);
+                    key.uv = corner.uv == missing ? missing : corner.uv + ((corner.relative & 2) ? uv_base : 0);
+                    key.normal = corner.normal == missing ? missing : corner.normal + ((corner.relative & 4) ? normal_base : 0);
+                    valid &= key.position >= 0 && key.position < static_cast<int32_t>(positions.size());
+                    valid &= key.uv == missing || (key.uv >= 0 && key.uv < static_cast<int32_t>(uvs.size()));
+                    valid &= key.normal == missing || (key.normal >= 0 && key.normal < static_cast<int32_t>(normals.size()));
+                    has_normals &= key.normal != missing;
+                }
+                if (!valid) {
+                    broken_faces++;
+                    continue;
+                }
+
+                // flat normal for faces that come without one, like assimp's GenNormals
+                glm::vec3 face_normal(0.0f);
+                if (!has_normals) {
+                    glm::vec3 p0 = positions[face_keys[0].position];
+                    glm::vec3 cross = glm::cross(positions[face_keys[1].position] - p0, positions[face_keys[2].position] - p0);
+                    float length = glm::length(cross);
+                    if (length > 0.0f) face_normal = cross / length;
+                }
+
+                // triangle fan, fine for the convex polygons modeling tools export
+                for (uint32_t i = 1; i + 1 < face.corner_count; i++) {
+                    keys[0] = face_keys[0];
+                    keys[1] = face_keys[i];
+                    keys[2] = face_keys[i + 1];
+                    for (const VertexKey& key: keys) {
+                        // vertices with generated normals belong to their face and are not shared
+                        if (key.normal != missing) {
+                            auto [it, inserted] = vertex_lookup.try_emplace(key, static_cast<uint32_t>(mesh.vertices.size()));
+                            mesh.indices.push_back(it->second);
+                            if (!inserted) continue;
+                        }
+                        else mesh.indices.push_back(static_cast<uint32_t>(mesh.vertices.size()));
+
+                        Mesh::Vertex& vertex = mesh.vertices.emplace_back();
+                        vertex.position = positions[key.position];
+                        vertex.normal = key.normal != missing ? normals[key.normal] : face_normal;
+                        vertex.color = glm::vec4(1.0f);
+                        // OpenGL prefers flipped y axis
+                        vertex.uv = key.uv != missing ? glm::vec2(uvs[key.uv].x, 1.0f - uvs[key.uv].y) : glm::vec2(0.0f);
+                        data.bounds_min = glm::min(data.bounds_min, vertex.position);
+                        data.bounds_max = glm::max(data.bounds_max, vertex.position);
+                    }
+                }
+            }
+            position_base += static_cast<int32_t>(chunk._positions.size());
+            uv_base += static_cast<int32_t>(chunk._uvs.size());
+            normal_base += static_cast<int32_t>(chunk._normals.size());
+        }
+
+        if (broken_faces > 0) fmt::println("Skipped {} faces with invalid indices in {}", broken_faces, path);
+        if (data.meshes.empty()) {
+            fmt::println("No faces found in model: {}", path);
+            data.bounds_min = glm::vec3(0.0f);
+            data.bounds_max = glm::vec3(0.0f);
+            return false;
+        }
+        return true;
+    }
+};
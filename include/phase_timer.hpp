@@ -0,0 +1,107 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/base.h>
+#include <fmt/format.h>
+
+// named wall clock timings of startup and loading phases
+// scopes may nest and may run on any thread, everything is relative to the first timing taken
+namespace PhaseTimer {
+    struct Phase {
+        std::string name;
+        double start_ms;
+        double duration_ms;
+        size_t thread; // hashed thread id, equal for all phases of one thread
+        uint32_t depth; // nesting level on that thread
+    };
+
+    struct Data {
+        std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+        std::vector<Phase> phases;
+        std::mutex mutex;
+
+        static Data& get() {
+            static Data instance;
+            return instance;
+        }
+    };
+
+    inline auto now_ms() -> double {
+        auto elapsed = std::chrono::steady_clock::now() - Data::get().origin;
+        return std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+
+    inline void record(std::string name, double start_ms, double duration_ms, uint32_t depth) {
+        Data& data = Data::get();
+        size_t thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+        std::lock_guard lock(data.mutex);
+        data.phases.push_back({ std::move(name), start_ms, duration_ms, thread, depth });
+    }
+
+    // times everything until the end of the enclosing block
+    struct Scope {
+        Scope(std::string name) : _name(std::move(name)), _start_ms(now_ms()), _depth(depth()++) {}
+        ~Scope() {
+            depth()--;
+            record(std::move(_name), _start_ms, now_ms() - _start_ms, _depth);
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        static uint32_t& depth() {
+            thread_local uint32_t depth = 0;
+            return depth;
+        }
+        std::string _name;
+        double _start_ms;
+        uint32_t _depth;
+    };
+
+    // machine readable report, phases are sorted by start time
+    inline void write_json(std::ostream& out) {
+        Data& data = Data::get();
+        std::lock_guard lock(data.mutex);
+        std::vector<Phase> phases = data.phases;
+        std::sort(phases.begin(), phases.end(), [](const Phase& a, const Phase& b) { return a.start_ms < b.start_ms; });
+        out << "{\n  \"phases\": [\n";
+        for (size_t i = 0; i < phases.size(); i++) {
+            const Phase& phase = phases[i];
+            std::string name;
+            for (char c: phase.name) {
+                if (c == '"' || c == '\\') name += '\\';
+                name += c;
+            }
+            out << fmt::format("    {{ \"name\": \"{}\", \"start_ms\": {:.3f}, \"duration_ms\": {:.3f}, \"thread\": {}, \"depth\": {} }}{}\n",
+                name, phase.start_ms, phase.duration_ms, phase.thread, phase.depth, i + 1 < phases.size() ? "," : "");
+        }
+        out << "  ]\n}\n";
+    }
+    inline bool write_json(const std::string& path) {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            fmt::println("Failed to write phase timings: {}", path);
+            return false;
+        }
+        write_json(file);
+        return true;
+    }
+
+    // human readable summary, indented by nesting
+    inline void print() {
+        Data& data = Data::get();
+        std::lock_guard lock(data.mutex);
+        std::vector<Phase> phases = data.phases;
+        std::sort(phases.begin(), phases.end(), [](const Phase& a, const Phase& b) { return a.start_ms < b.start_ms; });
+        for (const Phase& phase: phases) {
+            fmt::println("{:>10.2f} ms {:>9.2f} ms  {:{}}{}", phase.start_ms, phase.duration_ms, "", phase.depth * 2, phase.name);
+        }
+    }
+}
@@ -1,20 +1,30 @@
 #pragma once
-#include <fstream>
+#include <vector>
 #include <fmt/base.h>
+#include "files.hpp"
+#include "draw_stats.hpp"
+#include "gl_handle.hpp"
 #include <glbinding/gl46core/gl.h>
 using namespace gl46core;
 
 struct Pipeline {
-    // compile shaders and link shader program
+    // shader sources, can be read on any thread
+    struct Source {
+        FileData vs_file;
+        FileData fs_file;
+    };
+    static auto read(const char* vs_path, const char* fs_path) -> Source {
+        return { Files::load(vs_path), Files::load(fs_path) };
+    }
+
     void init(const char* vs_path, const char* fs_path) {
-        // read vertex shader data
-        std::ifstream vs_file(vs_path, std::ios::binary);
-        vs_file.seekg(0, std::ios::end);
-        GLint vs_size = vs_file.tellg();
-        vs_file.seekg(0, std::ios::beg);
-        std::vector<GLchar> vs_string(vs_size);
-        GLchar* vs_data = vs_string.data();
-        vs_file.read(vs_data, vs_size);
+        init(read(vs_path, fs_path));
+    }
+    // compile shaders and link shader program
+    void init(const Source& source) {
+        // vertex shader data
+        GLint vs_size = static_cast<GLint>(source.vs_file.size());
+        const GLchar* vs_data = reinterpret_cast<const GLchar*>(source.vs_file.data());
         // compile vertex shader
         GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
         glShaderSource(vertex_shader, 1, &vs_data, &vs_size);
@@ -28,14 +38,9 @@ struct Pipeline {
             fmt::print("{}", info_log.data());
         }
 
-        // read fragment shader data
-        std::ifstream fs_file(fs_path, std::ios::binary);
-        fs_file.seekg(0, std::ios::end);
-        GLint fs_size = fs_file.tellg();
-        fs_file.seekg(0, std::ios::beg);
-        std::vector<GLchar> fs_string(fs_size);
-        GLchar* fs_data = fs_string.data();
-        fs_file.read(fs_data, fs_size);
+        // fragment shader data
+        GLint fs_size = static_cast<GLint>(source.fs_file.size());
+        const GLchar* fs_data = reinterpret_cast<const GLchar*>(source.fs_file.data());
         // compile fragment shader
         GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
         glShaderSource(fragment_shader, 1, &fs_data, &fs_size);
@@ -47,7 +52,7 @@ struct Pipeline {
         }
 
         // to combine all shader stages, we create a shader program
-        _shader_program = glCreateProgram();
+        _shader_program = GlProgram::create("shader program");
         glAttachShader(_shader_program, vertex_shader);
         glAttachShader(_shader_program, fragment_shader);
         glLinkProgram(_shader_program);
@@ -63,20 +68,22 @@ struct Pipeline {
     
     void create_framebuffer() {
         // create frame buffer for shadow mapping pipeline
-        glCreateFramebuffers(1, &_framebuffer);
+        _framebuffer = GlFramebuffer::create("shadow framebuffer");
         // attach texture to frame buffer (only draw to depth, no color output -> GL_NONE)
         glNamedFramebufferReadBuffer(_framebuffer, GL_NONE);
         glNamedFramebufferDrawBuffer(_framebuffer, GL_NONE);
     }
-    // clean up shader program object
+    // clean up shader program object and the framebuffer if there is one, also happens when the pipeline is destroyed
     void destroy() {
-        glDeleteProgram(_shader_program);
+        _shader_program.reset();
+        _framebuffer.reset();
     }
     // bind the shader program (needs to be done before binding meshes or uniforms)
     void bind() {
         glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
         glUseProgram(_shader_program);
+        DrawStats::count_program_bind();
     }
-    GLuint _shader_program;
-    GLuint _framebuffer = 0;
+    GlProgram _shader_program;
+    GlFramebuffer _framebuffer; // 0 binds the default framebuffer
 };
\ No newline at end of file
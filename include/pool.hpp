@@ -0,0 +1,125 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+
+// refers to one object in a pool, goes stale once that object is despawned
+struct PoolHandle {
+    static constexpr uint32_t invalid_index = UINT32_MAX;
+    uint32_t index = invalid_index;
+    uint32_t generation = 0;
+};
+
+// usage numbers for the debug ui
+struct PoolStats {
+    const char* name;
+    uint32_t live;
+    uint32_t high_water;
+    uint32_t capacity;
+    size_t cpu_bytes; // objects plus bookkeeping, all allocated up front
+};
+
+// fixed capacity object pool with a free list
+// all memory is allocated in init(), spawn and despawn are O(1)
+// and live objects never move, so pointers stay valid until despawn
+template<typename T>
+struct Pool {
+    void init(uint32_t capacity) {
+        _capacity = capacity;
+        _objects = std::make_unique<T[]>(capacity);
+        _generations = std::make_unique<uint32_t[]>(capacity);
+        _free = std::make_unique<uint32_t[]>(capacity);
+        _live = std::make_unique<uint32_t[]>(capacity);
+        _live_slots = std::make_unique<uint32_t[]>(capacity);
+        for (uint32_t i = 0; i < capacity; i++) _generations[i] = 0;
+        _high_water = 0;
+        clear();
+    }
+
+    // grab a free object, returns nullptr when the pool is exhausted
+    // the object is not reset, it still holds whatever its previous user left in it
+    T* spawn(PoolHandle* handle_p = nullptr) {
+        if (_free_count == 0) return nullptr;
+        uint32_t index = _free[--_free_count];
+        _live_slots[index] = _live_count;
+        _live[_live_count++] = index;
+        if (_live_count > _high_water) _high_water = _live_count;
+        if (handle_p) *handle_p = { index, _generations[index] };
+        return &_objects[index];
+    }
+
+    void despawn(PoolHandle handle) {
+        if (get(handle) != nullptr) despawn_index(handle.index);
+    }
+
+    // despawn every live object the predicate returns true for
+    template<typename Predicate>
+    void despawn_if(Predicate predicate) {
+        // walk backwards, despawning swaps the last live object into the freed spot
+        for (uint32_t i = _live_count; i > 0; i--) {
+            uint32_t index = _live[i - 1];
+            if (predicate(_objects[index])) despawn_index(index);
+        }
+    }
+
+    // return every object to the free list, outstanding handles become stale
+    void clear() {
+        for (uint32_t i = 0; i < _live_count; i++) _generations[_live[i]]++;
+        _live_count = 0;
+        _free_count = _capacity;
+        // hand out low indices first
+        for (uint32_t i = 0; i < _capacity; i++) _free[i] = _capacity - 1 - i;
+    }
+
+    // resolve a handle, returns nullptr if it is stale
+    T* get(PoolHandle handle) {
+        if (handle.index >= _capacity) return nullptr;
+        if (_generations[handle.index] != handle.generation) return nullptr;
+        if (!is_live(handle.index)) return nullptr;
+        return &_objects[handle.index];
+    }
+
+    // iterate over live objects only
+    struct Iterator {
+        T& operator*() const { return _pool_p->_objects[_pool_p->_live[_i]]; }
+        T* operator->() const { return &**this; }
+        Iterator& operator++() { _i++; return *this; }
+        bool operator!=(const Iterator& other) const { return _i != other._i; }
+        Pool* _pool_p;
+        uint32_t _i;
+    };
+    Iterator begin() { return { this, 0 }; }
+    Iterator end() { return { this, _live_count }; }
+
+    uint32_t size() const { return _live_count; }
+    uint32_t capacity() const { return _capacity; }
+    bool full() const { return _free_count == 0; }
+    auto stats(const char* name) const -> PoolStats {
+        return { name, _live_count, _high_water, _capacity, static_cast<size_t>(_capacity) * (sizeof(T) + 4 * sizeof(uint32_t)) };
+    }
+
+private:
+    bool is_live(uint32_t index) const {
+        uint32_t slot = _live_slots[index];
+        return slot < _live_count && _live[slot] == index;
+    }
+
+    void despawn_index(uint32_t index) {
+        // swap the last live index into the freed spot of the dense list
+        uint32_t slot = _live_slots[index];
+        uint32_t last = _live[--_live_count];
+        _live[slot] = last;
+        _live_slots[last] = slot;
+        _generations[index]++;
+        _free[_free_count++] = index;
+    }
+
+    std::unique_ptr<T[]> _objects;
+    std::unique_ptr<uint32_t[]> _generations;
+    std::unique_ptr<uint32_t[]> _free; // stack of free indices
+    std::unique_ptr<uint32_t[]> _live; // dense list of live indices, used for iteration
+    std::unique_ptr<uint32_t[]> _live_slots; // position of each index inside _live
+    uint32_t _capacity = 0;
+    uint32_t _free_count = 0;
+    uint32_t _live_count = 0;
+    uint32_t _high_water = 0;
+};
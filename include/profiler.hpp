@@ -0,0 +1,170 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <fmt/base.h>
+#include <fmt/format.h>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define PROFILER_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define PROFILER_TSC
+#endif
+
+// scoped cpu profiling zones, recorded into per-thread rings only while a capture runs
+// a capture is written as chrome trace_event json, open it in perfetto or chrome://tracing
+// when no capture runs a zone costs one relaxed atomic load
+namespace Profiler {
+    static constexpr uint32_t capacity = 1 << 16; // zones kept per thread, older ones are overwritten
+
+    struct Record {
+        const char* name; // has to outlive the capture, use string literals
+        uint64_t begin;
+        uint64_t end;
+        uint32_t depth;
+    };
+
+    // records and head are written by its own thread only, read when a capture is saved
+    struct ThreadBuffer {
+        std::unique_ptr<Record[]> records = std::make_unique<Record[]>(capacity);
+        std::atomic<uint64_t> head = 0; // records ever written
+        uint64_t origin_head = 0; // head when the capture started, under Data::mutex
+        uint32_t depth = 0;
+        uint32_t id = 0;
+        const char* name_p = "thread"; // set once when the buffer is created
+    };
+
+    struct Data {
+        std::atomic<bool> enabled = false;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> threads;
+        // both clocks at the start of the capture, to convert ticks to time
+        uint64_t origin_ticks = 0;
+        std::chrono::steady_clock::time_point origin_time;
+
+        static Data& get() {
+            static Data instance;
+            return instance;
+        }
+    };
+
+    // time stamp counter where available, it is far cheaper to read than the os clocks
+    inline auto ticks() -> uint64_t {
+#ifdef PROFILER_TSC
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    inline auto thread_name() -> const char*& {
+        thread_local const char* name_p = "thread";
+        return name_p;
+    }
+    // the buffer is only created once the thread records its first zone
+    inline auto thread_buffer() -> ThreadBuffer& {
+        thread_local ThreadBuffer* buffer_p = nullptr;
+        if (buffer_p == nullptr) {
+            Data& data = Data::get();
+            std::lock_guard lock(data.mutex);
+            buffer_p = data.threads.emplace_back(std::make_unique<ThreadBuffer>()).get();
+            buffer_p->id = static_cast<uint32_t>(data.threads.size());
+            buffer_p->name_p = thread_name();
+        }
+        return *buffer_p;
+    }
+    // label for the thread in the trace, cheap enough to call every time a thread wakes up
+    // the trace keeps the name the thread had when it recorded its first zone
+    inline void set_thread_name(const char* name_p) {
+        thread_name() = name_p;
+    }
+
+    inline bool enabled() { return Data::get().enabled.load(std::memory_order_relaxed); }
+
+    // records everything until the end of the enclosing block
+    struct Zone {
+        Zone(const char* name_p) {
+            if (!enabled()) return;
+            _buffer_p = &thread_buffer();
+            _name_p = name_p;
+            _depth = _buffer_p->depth++;
+            _begin = ticks();
+        }
+        ~Zone() {
+            if (_buffer_p == nullptr) return;
+            uint64_t end = ticks();
+            _buffer_p->depth--;
+            uint64_t head = _buffer_p->head.load(std::memory_order_relaxed);
+            _buffer_p->records[head & (capacity - 1)] = { _name_p, _begin, end, _depth };
+            _buffer_p->head.store(head + 1, std::memory_order_release);
+        }
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        ThreadBuffer* _buffer_p = nullptr;
+        const char* _name_p = nullptr;
+        uint64_t _begin = 0;
+        uint32_t _depth = 0;
+    };
+
+    // start a new capture, everything recorded before it is left out of the trace
+    // head belongs to the recording thread, so the capture only remembers where it stood
+    inline void start() {
+        Data& data = Data::get();
+        {
+            std::lock_guard lock(data.mutex);
+            for (auto& thread_p: data.threads) thread_p->origin_head = thread_p->head.load(std::memory_order_acquire);
+            data.origin_ticks = ticks();
+            data.origin_time = std::chrono::steady_clock::now();
+        }
+        data.enabled.store(true, std::memory_order_release);
+    }
+    inline void stop() {
+        Data::get().enabled.store(false, std::memory_order_release);
+    }
+    inline bool capturing() { return enabled(); }
+
+    // zones that were still open when the capture stopped are not in it
+    inline bool write_trace(const std::string& path) {
+        Data& data = Data::get();
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            fmt::println("Failed to write profiler trace: {}", path);
+            return false;
+        }
+        // the tick rate follows from how far both clocks moved since the capture started
+        double elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - data.origin_time).count();
+        uint64_t elapsed_ticks = ticks() - data.origin_ticks;
+        double us_per_tick = elapsed_ticks > 0 ? elapsed_us / elapsed_ticks : 0.0;
+
+        std::lock_guard lock(data.mutex);
+        file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        bool first = true;
+        size_t zone_count = 0;
+        for (const auto& thread_p: data.threads) {
+            file << fmt::format("{}{{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": {}, \"args\": {{\"name\": \"{}\"}}}}",
+                first ? "" : ",\n", thread_p->id, thread_p->name_p);
+            first = false;
+            uint64_t head = thread_p->head.load(std::memory_order_acquire);
+            for (uint64_t i = std::max(thread_p->origin_head, head > capacity ? head - capacity : 0); i < head; i++) {
+                const Record& record = thread_p->records[i & (capacity - 1)];
+                // zones that closed while the capture started can still have begun before it
+                if (record.begin < data.origin_ticks) continue;
+                file << fmt::format(",\n{{\"name\": \"{}\", \"ph\": \"X\", \"pid\": 1, \"tid\": {}, \"ts\": {:.3f}, \"dur\": {:.3f}, \"args\": {{\"depth\": {}}}}}",
+                    record.name, thread_p->id, (record.begin - data.origin_ticks) * us_per_tick, (record.end - record.begin) * us_per_tick, record.depth);
+                zone_count++;
+            }
+        }
+        file << "\n]}\n";
+        fmt::println("Wrote {} profiler zones to {}", zone_count, path);
+        return true;
+    }
+}
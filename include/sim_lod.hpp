@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// decides how often an entity gets simulated based on distance and visibility
+// far away entities are updated every few ticks with the summed up delta time
+struct SimLod {
+    enum Tier : uint8_t { eNear, eMid, eFar, eTierCount };
+
+    // call once per tick before classifying anything
+    void begin_tick(const glm::mat4& view_projection, const glm::vec3& focus) {
+        _view_projection = view_projection;
+        _focus = focus;
+        _tick++;
+        _tier_counts = {};
+    }
+
+    Tier classify(const glm::vec3& position) {
+        glm::vec3 to_focus = position - _focus;
+        float distance_sq = glm::dot(to_focus, to_focus);
+        Tier tier;
+        if (distance_sq < _near_radius * _near_radius || on_screen(position)) tier = eNear;
+        else if (distance_sq < _mid_radius * _mid_radius) tier = eMid;
+        else tier = eFar;
+        _tier_counts[tier]++;
+        return tier;
+    }
+
+    // phase staggers entities of one tier across ticks so the cost stays even
+    bool due(Tier tier, uint32_t phase) const {
+        uint32_t interval = _intervals[tier];
+        return (_tick + phase) % interval == 0;
+    }
+
+    bool on_screen(const glm::vec3& position) const {
+        glm::vec4 clip = _view_projection * glm::vec4(position, 1.0f);
+        if (clip.w <= 0.0f) return false;
+        float limit = clip.w * _screen_margin;
+        return clip.x >= -limit && clip.x <= limit && clip.y >= -limit && clip.y <= limit;
+    }
+
+    float _near_radius = 25.0f;
+    float _mid_radius = 55.0f;
+    float _screen_margin = 1.2f; // grow the view a bit so nothing pops at the border
+    std::array<uint32_t, eTierCount> _intervals = { 1, 2, 4 }; // ticks between updates
+    std::array<uint32_t, eTierCount> _tier_counts = {};
+
+private:
+    glm::mat4 _view_projection = glm::mat4(1.0f);
+    glm::vec3 _focus = glm::vec3(0.0f);
+    uint32_t _tick = 0;
+};
@@ -0,0 +1,156 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include <SDL3/SDL_audio.h>
+#include <SDL3/SDL_iostream.h>
+#include <fmt/base.h>
+#include "files.hpp"
+#include "phase_timer.hpp"
+
+// every sound effect the game plays, indexes into the SoundBank
+enum class SoundId : uint8_t { eJump, eBigBlob, eLevelUp, eContact, eHit, eEat, eShot, eWin, eGameOver, eCount };
+
+// short sound effects are decoded once at startup and converted to the mixer format,
+// long ones stay in their mapped file and the mixer streams them, either way playing never loads anything
+struct SoundBank {
+    struct Info {
+        const char* path;
+        uint8_t priority; // higher priority sounds may take voices from lower ones
+        uint8_t max_voices; // how many instances may play at once
+    };
+    struct Sound {
+        std::vector<float> samples; // resident sounds, interleaved in the format given to init()
+        uint32_t frames = 0; // at the mixer rate, estimated for streamed sounds
+        uint8_t priority = 0;
+        uint8_t max_voices = 0;
+        // streamed sounds keep their file mapped and are converted in chunks while playing
+        bool streamed = false;
+        FileData file;
+        SDL_AudioSpec file_spec = {};
+        const uint8_t* pcm_p = nullptr; // the wav data chunk inside file
+        uint32_t pcm_bytes = 0;
+    };
+
+    static constexpr std::array<Info, static_cast<size_t>(SoundId::eCount)> infos = {{
+        { "audio/jump.wav", 2, 2 },
+        { "audio/big_blob.wav", 3, 2 },
+        { "audio/lvlup.wav", 4, 1 },
+        { "audio/contact.wav", 1, 4 },
+        { "audio/hit.wav", 1, 4 },
+        { "audio/eat.wav", 2, 3 },
+        { "audio/shot.wav", 1, 4 },
+        { "audio/win.wav", 5, 1 },
+        { "audio/game_over.wav", 5, 1 },
+    }};
+
+    // files at least this big are streamed instead of decoded up front
+    static constexpr size_t default_stream_threshold = 300 * 1024;
+
+    // spec has to be a float format, that is what the mixer adds up
+    // AUDIO_STREAM_THRESHOLD_KB overrides stream_threshold
+    void init(const SDL_AudioSpec& spec, size_t stream_threshold = default_stream_threshold) {
+        _spec = spec;
+        if (const char* threshold_p = std::getenv("AUDIO_STREAM_THRESHOLD_KB")) stream_threshold = std::strtoull(threshold_p, nullptr, 10) * 1024;
+        uint32_t streamed_count = 0;
+        for (size_t i = 0; i < infos.size(); i++) {
+            PhaseTimer::Scope phase(std::string("decode ") + infos[i].path);
+            Sound& sound = _sounds[i];
+            FileData file = Files::load(infos[i].path);
+            if (!file) continue;
+            if (file.size() < stream_threshold || !open_stream(infos[i].path, file, sound)) {
+                sound = decode(infos[i].path, file);
+            }
+            sound.priority = infos[i].priority;
+            sound.max_voices = infos[i].max_voices;
+            _bytes += sound.samples.size() * sizeof(float);
+            streamed_count += sound.streamed;
+        }
+        fmt::println("Sound bank: {} sounds ({} streamed), {} KB resident at {} Hz, {} channels",
+            infos.size(), streamed_count, _bytes / 1024, _spec.freq, _spec.channels);
+    }
+    void destroy() {
+        for (Sound& sound: _sounds) sound = {};
+        _bytes = 0;
+    }
+
+    auto sound(SoundId id) const -> const Sound& { return _sounds[static_cast<size_t>(id)]; }
+    auto spec() const -> const SDL_AudioSpec& { return _spec; }
+    auto resident_bytes() const -> size_t { return _bytes; }
+
+private:
+    auto decode(const char* path, const FileData& file) const -> Sound {
+        Sound sound;
+        SDL_AudioSpec file_spec;
+        Uint8* file_samples_p = nullptr;
+        Uint32 file_size = 0;
+        if (!SDL_LoadWAV_IO(SDL_IOFromConstMem(file.data(), file.size()), true, &file_spec, &file_samples_p, &file_size)) {
+            fmt::println("Failed to decode {}: {}", path, SDL_GetError());
+            return sound;
+        }
+        Uint8* samples_p = nullptr;
+        int size = 0;
+        if (SDL_ConvertAudioSamples(&file_spec, file_samples_p, static_cast<int>(file_size), &_spec, &samples_p, &size)) {
+            sound.samples.resize(size / sizeof(float));
+            std::memcpy(sound.samples.data(), samples_p, sound.samples.size() * sizeof(float));
+            sound.frames = static_cast<uint32_t>(sound.samples.size() / _spec.channels);
+        }
+        else fmt::println("Failed to convert {}: {}", path, SDL_GetError());
+        SDL_free(samples_p);
+        SDL_free(file_samples_p);
+        return sound;
+    }
+
+    // finds the format and data chunks of a plain pcm or float wav,
+    // anything fancier falls back to being decoded by SDL
+    bool open_stream(const char* path, FileData& file, Sound& sound) const {
+        auto read_u16 = [&](size_t offset) { return static_cast<uint32_t>(file.data()[offset] | file.data()[offset + 1] << 8); };
+        auto read_u32 = [&](size_t offset) { return read_u16(offset) | read_u16(offset + 2) << 16; };
+        auto tag = [&](size_t offset) { return std::string_view(reinterpret_cast<const char*>(file.data() + offset), 4); };
+        if (file.size() < 12 || tag(0) != "RIFF" || tag(8) != "WAVE") return false;
+
+        SDL_AudioSpec file_spec = {};
+        const uint8_t* pcm_p = nullptr;
+        uint32_t pcm_bytes = 0;
+        for (size_t offset = 12; offset + 8 <= file.size();) {
+            uint32_t size = read_u32(offset + 4);
+            size_t body = offset + 8;
+            if (size > file.size() - body) size = static_cast<uint32_t>(file.size() - body);
+            if (tag(offset) == "fmt " && size >= 16) {
+                uint32_t format = read_u16(body);
+                uint32_t bits = read_u16(body + 14);
+                file_spec.channels = static_cast<int>(read_u16(body + 2));
+                file_spec.freq = static_cast<int>(read_u32(body + 4));
+                if (format == 1 && bits == 8) file_spec.format = SDL_AUDIO_U8;
+                else if (format == 1 && bits == 16) file_spec.format = SDL_AUDIO_S16LE;
+                else if (format == 1 && bits == 32) file_spec.format = SDL_AUDIO_S32LE;
+                else if (format == 3 && bits == 32) file_spec.format = SDL_AUDIO_F32LE;
+                else return false;
+            }
+            else if (tag(offset) == "data") {
+                pcm_p = file.data() + body;
+                pcm_bytes = size;
+            }
+            offset = body + size + (size & 1); // chunks are padded to even sizes
+        }
+        if (file_spec.format == SDL_AUDIO_UNKNOWN || file_spec.channels == 0 || file_spec.freq == 0 || pcm_p == nullptr) {
+            fmt::println("Cannot stream {}, decoding it instead", path);
+            return false;
+        }
+        uint64_t file_frames = pcm_bytes / (SDL_AUDIO_BYTESIZE(file_spec.format) * file_spec.channels);
+        sound.frames = static_cast<uint32_t>(file_frames * _spec.freq / file_spec.freq);
+        sound.streamed = true;
+        sound.file_spec = file_spec;
+        sound.pcm_p = pcm_p;
+        sound.pcm_bytes = pcm_bytes;
+        sound.file = std::move(file); // archive views and mappings stay valid when moved
+        return true;
+    }
+
+    SDL_AudioSpec _spec = {};
+    std::array<Sound, static_cast<size_t>(SoundId::eCount)> _sounds = {};
+    size_t _bytes = 0;
+};
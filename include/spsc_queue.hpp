@@ -0,0 +1,34 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+// fixed size lock-free queue for exactly one producer thread and one consumer thread
+template<typename T, uint32_t capacity>
+struct SpscQueue {
+    static_assert(std::has_single_bit(capacity), "capacity has to be a power of two");
+
+    // producer side, fails when the queue is full
+    bool push(const T& item) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == capacity) return false;
+        _items[head & (capacity - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    // consumer side, fails when the queue is empty
+    bool pop(T& item) {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return false;
+        item = _items[tail & (capacity - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // both ends on their own cache line so the threads do not fight over it
+    alignas(64) std::atomic<uint32_t> _head = 0;
+    alignas(64) std::atomic<uint32_t> _tail = 0;
+    std::array<T, capacity> _items;
+};
@@ -12,6 +12,11 @@ namespace Time {
             high_resolution_clock::time_point start;
             // timestamp of previous frame
             high_resolution_clock::time_point previous;
+            // fixed simulation step
+            double fixed_delta = 1.0 / 60.0;
+            double accumulator;
+            // longest frame that is fed into the simulation (avoids spiral of death)
+            double max_frame = 0.25;
         };
         // for internal use only
         auto static get() -> Timestamps& {
@@ -26,6 +31,7 @@ namespace Time {
         timestamps.previous = timestamps.start;
         timestamps.delta = 0.0;
         timestamps.total = 0.0;
+        timestamps.accumulator = 0.0;
     }
     // call once per frame
     void static update() {
@@ -49,4 +55,30 @@ namespace Time {
     auto static get_total() -> double {
         return internal::get().total;
     }
+
+    // set the simulation rate in ticks per second
+    void static set_tick_rate(double ticks_per_second) {
+        internal::get().fixed_delta = 1.0 / ticks_per_second;
+    }
+    // time (seconds) simulated by a single tick
+    auto static get_fixed_delta() -> double {
+        return internal::get().fixed_delta;
+    }
+    // add frame time that still has to be simulated
+    void static accumulate(double delta) {
+        internal::Timestamps& timestamps = internal::get();
+        timestamps.accumulator += delta < timestamps.max_frame ? delta : timestamps.max_frame;
+    }
+    // consume one tick worth of accumulated time, returns false once there is not enough left
+    bool static consume_tick() {
+        internal::Timestamps& timestamps = internal::get();
+        if (timestamps.accumulator < timestamps.fixed_delta) return false;
+        timestamps.accumulator -= timestamps.fixed_delta;
+        return true;
+    }
+    // how far (0-1) rendering is between the previous and the current tick
+    auto static get_alpha() -> double {
+        internal::Timestamps& timestamps = internal::get();
+        return timestamps.accumulator / timestamps.fixed_delta;
+    }
 };
\ No newline at end of file
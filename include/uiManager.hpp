@@ -1,14 +1,21 @@
 // UIManager.h
 #pragma once
+#include <cfloat>
 #include <imgui.h>
 #include <imgui_impl_sdl3.h>
 #include <imgui_impl_opengl3.h>
 #include "entities/player.hpp"
 #include "entities/upgrade.hpp"
 #include "state.hpp"
+#include "debug_stats.hpp"
+#include "draw_stats.hpp"
 
 class UIManager {
 public:
+    // set by the debug window, handled and cleared by the engine
+    bool _export_frame_times = false;
+    bool _toggle_profiler = false;
+
     void init(SDL_Window* window, SDL_GLContext context) {
         IMGUI_CHECKVERSION();
         ImGui::CreateContext();
@@ -27,9 +34,11 @@ public:
         ImGui_ImplSDL3_Shutdown();
         ImGui::DestroyContext();
     }
-    bool render(Player& player, int window_width, int window_height, bool showing_upgrades, const std::vector<Upgrade> upgrades, float time) {
+    bool render(Player& player, int window_width, int window_height, bool showing_upgrades, const std::vector<Upgrade>& upgrades, float time, const DebugStats& stats) {
+        AllocTracker::Scope alloc_scope(AllocTracker::Subsystem::eUI);
         start_frame();
         show_fps_window();
+        show_debug_window(stats, window_width);
         show_health_bar(player, window_width, window_height);
         show_xp_bar(player, window_width, window_height);
         show_timer(time);
@@ -65,7 +74,8 @@ public:
         return showing_upgrades;
     }
 
-    void render_main_menu(GameState& gameState, int window_width, int window_height) {
+    void render_main_menu(GameState& gameState, int window_width, int window_height, float load_progress) {
+        AllocTracker::Scope alloc_scope(AllocTracker::Subsystem::eUI);
         start_frame();
     
         ImGui::SetNextWindowPos(ImVec2(window_width / 2 - 200, window_height / 3 - 50));
@@ -91,9 +101,14 @@ public:
         ImGui::Spacing();
     
         // Botones
-        if (ImGui::Button("Start Game", ImVec2(300, 60))) {
+        // assets are still streaming in, the game can only start once they are all uploaded
+        bool loading = load_progress < 1.0f;
+        ImGui::BeginDisabled(loading);
+        if (ImGui::Button(loading ? "Loading..." : "Start Game", ImVec2(300, 60))) {
             gameState = GameState::RESET;
         }
+        ImGui::EndDisabled();
+        if (loading) ImGui::ProgressBar(load_progress, ImVec2(300, 0));
     
         ImGui::Spacing();
     
@@ -107,6 +122,7 @@ public:
     }
 
     void render_over_menu(GameState& gameState, int window_width, int window_height) {
+        AllocTracker::Scope alloc_scope(AllocTracker::Subsystem::eUI);
         start_frame();
     
         ImGui::SetNextWindowPos(ImVec2(window_width / 2 - 200, window_height / 3 - 50));
@@ -136,6 +152,7 @@ public:
     }
 
     void render_win_menu(GameState& gameState, int window_width, int window_height) {
+        AllocTracker::Scope alloc_scope(AllocTracker::Subsystem::eUI);
         start_frame();
     
         ImGui::SetNextWindowPos(ImVec2(window_width / 2 - 200, window_height / 3 - 50));
@@ -174,6 +191,23 @@ public:
     void end_frame() {
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        count_draws(ImGui::GetDrawData());
+    }
+
+    // the opengl3 backend binds its program and vertex array once, then a texture and a draw per command
+    void count_draws(const ImDrawData* draw_data_p) {
+        DrawStats::set_pass(DrawStats::Pass::eUI);
+        if (draw_data_p == nullptr || draw_data_p->CmdListsCount == 0) return;
+        DrawStats::count_program_bind();
+        DrawStats::count_vao_bind();
+        for (int list_i = 0; list_i < draw_data_p->CmdListsCount; list_i++) {
+            const ImDrawList* list_p = draw_data_p->CmdLists[list_i];
+            for (const ImDrawCmd& command: list_p->CmdBuffer) {
+                if (command.UserCallback != nullptr) continue;
+                DrawStats::count_texture_bind();
+                DrawStats::count_draw(command.ElemCount / 3);
+            }
+        }
     }
 
     void show_fps_window() {
@@ -188,6 +222,123 @@ public:
         ImGui::End();
     }
 
+    void show_debug_window(const DebugStats& stats, int window_width) {
+        ImGui::SetNextWindowPos(ImVec2(window_width - 330.0f, 80), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowSize(ImVec2(300, 0), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Debug", nullptr, ImGuiWindowFlags_NoFocusOnAppearing);
+
+        if (ImGui::CollapsingHeader("Pools")) {
+            // live / high-water / capacity of each entity pool
+            for (const PoolStats& pool : stats.pools) {
+                ImGui::Text("%-12s %5u / %5u / %5u  %7.1f KB", pool.name, pool.live, pool.high_water, pool.capacity, pool.cpu_bytes / 1024.0f);
+            }
+            ImGui::Text("%-12s %30.1f KB", "model table", stats.model_table_bytes / 1024.0f);
+        }
+        if (ImGui::CollapsingHeader("Simulation LOD")) {
+            ImGui::Text("near %u  mid %u  far %u", stats.lod_tiers[0], stats.lod_tiers[1], stats.lod_tiers[2]);
+            ImGui::Text("recycled %u", stats.recycled_enemies);
+        }
+        if (ImGui::CollapsingHeader("Assets")) {
+            size_t total_bytes = 0;
+            for (const auto& asset : stats.assets) {
+                ImGui::Text("%3u refs %7.2f + %5.2f ms %-5s %7.1f KB  %s", asset.refs, asset.read_ms, asset.upload_ms, asset.cached ? "warm" : "cold", asset.gpu_bytes / 1024.0f, asset.name.c_str());
+                total_bytes += asset.gpu_bytes;
+            }
+            ImGui::Text("total GPU memory %.1f KB", total_bytes / 1024.0f);
+        }
+        if (stats.frame_stats_p != nullptr && ImGui::CollapsingHeader("Frame times")) {
+            const FrameStats& frames = *stats.frame_stats_p;
+            const FrameStats::Summary& summary = frames.summary();
+            ImGui::Text("p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms", summary.p50, summary.p95, summary.p99, summary.max);
+            ImGui::PlotLines("##frame_times", &frames.frames()[0].total_ms, frames.count(), frames.oldest(), nullptr, 0.0f, 50.0f, ImVec2(0, 60), sizeof(FrameStats::Frame));
+            ImGui::PlotHistogram("##frame_histogram", frames.histogram().data(), FrameStats::histogram_buckets, 0, "1 ms buckets", 0.0f, FLT_MAX, ImVec2(0, 60));
+            for (size_t phase = 0; phase < FrameStats::phase_count; phase++) {
+                if (FrameStats::gpu_phases[phase]) ImGui::Text("%-12s %6.3f ms  gpu %6.3f ms", FrameStats::phase_names[phase], summary.phase_mean_ms[phase], summary.gpu_mean_ms[phase]);
+                else ImGui::Text("%-12s %6.3f ms", FrameStats::phase_names[phase], summary.phase_mean_ms[phase]);
+            }
+            if (stats.gpu_timer_p != nullptr && ImGui::TreeNode("GPU passes")) {
+                for (const GpuTimer::Pass& pass: stats.gpu_timer_p->passes()) {
+                    const char* name_p = FrameStats::phase_names[static_cast<size_t>(pass.phase)];
+                    if (pass.light >= 0) ImGui::Text("%s light %d face %d  %6.3f ms", name_p, pass.light, pass.face, pass.ms);
+                    else ImGui::Text("%-12s %6.3f ms", name_p, pass.ms);
+                }
+                ImGui::Text("readbacks skipped %u", stats.gpu_timer_p->skipped());
+                ImGui::TreePop();
+            }
+            if (ImGui::Button("Export CSV/JSON")) _export_frame_times = true;
+        }
+        if (stats.draw_stats_p != nullptr && ImGui::CollapsingHeader("Draw calls")) {
+            // calls / triangles / program, vertex array and texture binds / uniform uploads of the last frame
+            const DrawStats::Frame& draws = *stats.draw_stats_p;
+            auto row = [](const char* name_p, const DrawStats::Counters& counters) {
+                ImGui::Text("%-12s %5u %8u  %3u %5u %5u  %6u", name_p, counters.draw_calls, counters.triangles,
+                    counters.program_binds, counters.vao_binds, counters.texture_binds, counters.uniform_uploads);
+            };
+            ImGui::Text("%-12s %5s %8s  %3s %5s %5s  %6s", "", "calls", "tris", "prg", "vao", "tex", "unif");
+            for (size_t pass = 0; pass < DrawStats::pass_count; pass++) {
+                row(DrawStats::pass_names[pass], draws.pass_total(static_cast<DrawStats::Pass>(pass)));
+            }
+            ImGui::Separator();
+            for (size_t category = 0; category < DrawStats::category_count; category++) {
+                row(DrawStats::category_names[category], draws.category_total(static_cast<DrawStats::Category>(category)));
+            }
+            if (ImGui::TreeNode("By pass and category")) {
+                for (size_t pass = 0; pass < DrawStats::pass_count; pass++) {
+                    for (size_t category = 0; category < DrawStats::category_count; category++) {
+                        const DrawStats::Counters& counters = draws.counters[pass][category];
+                        if (counters.draw_calls == 0 && counters.uniform_uploads == 0) continue;
+                        ImGui::Text("%-8s %-12s %5u calls %8u tris %5u instances", DrawStats::pass_names[pass], DrawStats::category_names[category],
+                            counters.draw_calls, counters.triangles, counters.instances);
+                    }
+                }
+                ImGui::TreePop();
+            }
+        }
+        if (stats.gl_resources_p != nullptr && ImGui::CollapsingHeader("GL resources")) {
+            // live objects and estimated vram of everything the engine created
+            const GlResources::Totals& resources = *stats.gl_resources_p;
+            size_t total_bytes = 0;
+            for (size_t type = 0; type < GlResources::type_count; type++) {
+                ImGui::Text("%-14s %5u  %9.1f KB", GlResources::type_names[type], resources.counts[type], resources.bytes[type] / 1024.0f);
+                total_bytes += resources.bytes[type];
+            }
+            ImGui::Text("estimated vram %.1f MB", total_bytes / (1024.0f * 1024.0f));
+        }
+        if (ImGui::CollapsingHeader("Heap allocations")) {
+            if (stats.alloc_p == nullptr) {
+                ImGui::Text("build with ALLOC_TRACKING to count them");
+            }
+            else {
+                // last frame's allocations and bytes, then what each subsystem still holds
+                const AllocTracker::Data& allocs = *stats.alloc_p;
+                for (size_t i = 0; i < AllocTracker::subsystem_count; i++) {
+                    ImGui::Text("%-8s %5llu  %8.1f KB  live %9.1f KB", AllocTracker::subsystem_names[i],
+                        static_cast<unsigned long long>(allocs.last_frame_allocations[i]), allocs.last_frame_bytes[i] / 1024.0f,
+                        allocs.counters[i].live_bytes.load(std::memory_order_relaxed) / 1024.0f);
+                }
+                ImGui::Text("in no-alloc regions %llu", static_cast<unsigned long long>(allocs.violations.load(std::memory_order_relaxed)));
+            }
+        }
+        if (ImGui::CollapsingHeader("Frame arena")) {
+            ImGui::Text("last frame %.1f KB  high water %.1f KB", stats.arena_frame_bytes / 1024.0f, stats.arena_high_water / 1024.0f);
+            ImGui::Text("capacity %.1f KB  overflows %u", stats.arena_capacity / 1024.0f, stats.arena_overflows);
+            ImGui::Text("worker job high water %.1f KB", stats.worker_arena_high_water / 1024.0f);
+        }
+        if (ImGui::CollapsingHeader("Profiler")) {
+            ImGui::Text(stats.profiling ? "capturing" : "idle");
+            if (ImGui::Button(stats.profiling ? "Stop and save trace" : "Start capture")) _toggle_profiler = true;
+        }
+        if (ImGui::CollapsingHeader("Frame pacing")) {
+            ImGui::Text("%s  frame %.2f ms  limiter %.2f ms", stats.pacing_mode, stats.frame_ms, stats.pacing_wait_ms);
+            ImGui::Text("input to display ~%.1f ms", stats.latency_ms);
+        }
+        if (ImGui::CollapsingHeader("Audio")) {
+            ImGui::Text("voices %u / %u  dropped %u", stats.audio_voices, Mixer::voice_count, stats.audio_dropped);
+            ImGui::Text("samples %.1f KB", stats.audio_bytes / 1024.0f);
+        }
+        ImGui::End();
+    }
+
     void show_timer(float elapsed_time) {
         ImGui::SetNextWindowPos(ImVec2(30, 50), ImGuiCond_Always);
         ImGui::Begin("Survival Time", nullptr, 
@@ -0,0 +1,60 @@
+// replaces the global allocation functions to feed AllocTracker, only built with the ALLOC_TRACKING option
+#include <cstdlib>
+#include <new>
+#include "alloc_tracker.hpp"
+
+namespace {
+    // sits right before every block, so delete knows the size and subsystem without sized deallocation
+    struct alignas(16) Header {
+        size_t size;
+        uint32_t offset; // from the start of the malloc'd block
+        AllocTracker::Subsystem subsystem;
+    };
+    static_assert(sizeof(Header) == 16);
+
+    void* allocate(size_t size, size_t alignment) {
+        // malloc already aligns to 16, larger alignments need room to move the block forward
+        alignment = alignment < alignof(Header) ? alignof(Header) : alignment;
+        std::byte* raw_p = static_cast<std::byte*>(std::malloc(size + sizeof(Header) + alignment - alignof(Header)));
+        if (raw_p == nullptr) return nullptr;
+        uintptr_t user = (reinterpret_cast<uintptr_t>(raw_p) + sizeof(Header) + alignment - 1) & ~(alignment - 1);
+        Header* header_p = reinterpret_cast<Header*>(user) - 1;
+        header_p->size = size;
+        header_p->offset = static_cast<uint32_t>(user - reinterpret_cast<uintptr_t>(raw_p));
+        header_p->subsystem = AllocTracker::on_allocate(size);
+        return reinterpret_cast<void*>(user);
+    }
+    void* allocate_or_throw(size_t size, size_t alignment) {
+        void* memory_p = allocate(size, alignment);
+        if (memory_p == nullptr) throw std::bad_alloc();
+        return memory_p;
+    }
+    void deallocate(void* memory_p) {
+        if (memory_p == nullptr) return;
+        Header* header_p = static_cast<Header*>(memory_p) - 1;
+        AllocTracker::on_free(header_p->size, header_p->subsystem);
+        std::free(static_cast<std::byte*>(memory_p) - header_p->offset);
+    }
+}
+
+void* operator new(size_t size) { return allocate_or_throw(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return allocate_or_throw(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocate_or_throw(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocate_or_throw(size, static_cast<size_t>(alignment)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate(size, static_cast<size_t>(alignment)); }
+
+void operator delete(void* memory_p) noexcept { deallocate(memory_p); }
+void operator delete[](void* memory_p) noexcept { deallocate(memory_p); }
+void operator delete(void* memory_p, size_t) noexcept { deallocate(memory_p); }
+void operator delete[](void* memory_p, size_t) noexcept { deallocate(memory_p); }
+void operator delete(void* memory_p, std::align_val_t) noexcept { deallocate(memory_p); }
+void operator delete[](void* memory_p, std::align_val_t) noexcept { deallocate(memory_p); }
+void operator delete(void* memory_p, size_t, std::align_val_t) noexcept { deallocate(memory_p); }
+void operator delete[](void* memory_p, size_t, std::align_val_t) noexcept { deallocate(memory_p); }
+void operator delete(void* memory_p, const std::nothrow_t&) noexcept { deallocate(memory_p); }
+void operator delete[](void* memory_p, const std::nothrow_t&) noexcept { deallocate(memory_p); }
+void operator delete(void* memory_p, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(memory_p); }
+void operator delete[](void* memory_p, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(memory_p); }
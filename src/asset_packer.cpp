@@ -0,0 +1,141 @@
+#include <bit>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <fmt/base.h>
+#include "files.hpp"
+#include "mesh_cache.hpp"
+
+// packs every file under the assets directory into one archive, see files.hpp for the layout
+// obj models additionally get their binary mesh cache baked in, so the game never parses them
+// usage: asset-packer <assets dir> <output file> [--lz4]
+struct PackedFile {
+    std::string name;
+    std::vector<uint8_t> bytes;
+    Archive::Compression compression = Archive::Compression::eNone;
+    uint64_t size = 0; // uncompressed
+};
+
+static auto read_file(const std::filesystem::path& path) -> std::vector<uint8_t> {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void compress(PackedFile& file) {
+#ifdef ARCHIVE_LZ4
+    std::vector<uint8_t> compressed(LZ4_compressBound(static_cast<int>(file.bytes.size())));
+    int compressed_size = LZ4_compress_default(reinterpret_cast<const char*>(file.bytes.data()), reinterpret_cast<char*>(compressed.data()),
+        static_cast<int>(file.bytes.size()), static_cast<int>(compressed.size()));
+    // only worth it if it saves a good chunk, otherwise keep the zero copy path
+    if (compressed_size > 0 && compressed_size < file.bytes.size() * 9 / 10) {
+        compressed.resize(compressed_size);
+        file.bytes = std::move(compressed);
+        file.compression = Archive::Compression::eLZ4;
+    }
+#else
+    (void)file;
+#endif
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fmt::println("usage: {} <assets dir> <output file> [--lz4]", argv[0]);
+        return 1;
+    }
+    std::filesystem::path root = argv[1];
+    std::filesystem::path output_path = argv[2];
+    bool use_lz4 = argc > 3 && std::string(argv[3]) == "--lz4";
+#ifndef ARCHIVE_LZ4
+    if (use_lz4) fmt::println("Built without LZ4 support, packing uncompressed");
+#endif
+
+    // model parsing reads through Files, point it at the loose assets
+    Files::init_loose(root.generic_string() + "/");
+
+    std::vector<PackedFile> files;
+    for (const auto& item: std::filesystem::recursive_directory_iterator(root)) {
+        if (!item.is_regular_file()) continue;
+        std::string name = item.path().lexically_relative(root).generic_string();
+        // stale local caches are never packed, fresh ones are baked below
+        if (item.path().extension() == ".mesh") continue;
+        PackedFile& file = files.emplace_back();
+        file.name = name;
+        file.bytes = read_file(item.path());
+
+        if (item.path().extension() == ".obj") {
+            ModelData data;
+            if (!MeshCache::import(name, data)) return 1;
+            std::ostringstream cache;
+            MeshCache::write(cache, data);
+            std::string cache_bytes = cache.str();
+            PackedFile& cache_file = files.emplace_back();
+            cache_file.name = MeshCache::cache_path(name);
+            cache_file.bytes.assign(cache_bytes.begin(), cache_bytes.end());
+        }
+    }
+    std::sort(files.begin(), files.end(), [](const PackedFile& a, const PackedFile& b) { return a.name < b.name; });
+    for (PackedFile& file: files) {
+        file.size = file.bytes.size();
+        if (use_lz4) compress(file);
+    }
+
+    // hash table of contents, at most half full
+    Archive::Header header = {};
+    std::memcpy(header.magic, Archive::magic, sizeof(Archive::magic));
+    header.version = Archive::version;
+    header.entry_count = static_cast<uint32_t>(files.size());
+    header.table_size = std::bit_ceil(std::max<uint32_t>(2 * header.entry_count, 16));
+    header.names_offset = sizeof(Archive::Header) + header.table_size * sizeof(Archive::Entry);
+
+    std::string names;
+    for (const PackedFile& file: files) names += file.name;
+    uint64_t offset = header.names_offset + names.size();
+
+    std::vector<Archive::Entry> table(header.table_size, Archive::Entry{});
+    uint32_t name_offset = 0;
+    for (const PackedFile& file: files) {
+        Archive::Entry entry = {};
+        entry.hash = Archive::hash(file.name);
+        offset = (offset + Archive::alignment - 1) / Archive::alignment * Archive::alignment;
+        entry.offset = offset;
+        entry.size = file.size;
+        entry.stored_size = file.bytes.size();
+        entry.name_offset = name_offset;
+        entry.name_length = static_cast<uint32_t>(file.name.size());
+        entry.compression = file.compression;
+        offset += file.bytes.size();
+        name_offset += entry.name_length;
+
+        uint32_t slot = entry.hash & (header.table_size - 1);
+        while (table[slot].hash != 0) slot = (slot + 1) & (header.table_size - 1);
+        table[slot] = entry;
+    }
+
+    std::ofstream output(output_path, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        fmt::println("Failed to write archive: {}", output_path.string());
+        return 1;
+    }
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(Archive::Entry));
+    output.write(names.data(), names.size());
+    uint64_t position = header.names_offset + names.size();
+    uint64_t stored_bytes = 0, raw_bytes = 0;
+    for (const PackedFile& file: files) {
+        uint64_t aligned = (position + Archive::alignment - 1) / Archive::alignment * Archive::alignment;
+        for (; position < aligned; position++) output.put(0);
+        output.write(reinterpret_cast<const char*>(file.bytes.data()), file.bytes.size());
+        position += file.bytes.size();
+        stored_bytes += file.bytes.size();
+        raw_bytes += file.size;
+    }
+    if (!output) {
+        fmt::println("Failed to write archive: {}", output_path.string());
+        return 1;
+    }
+    fmt::println("Packed {} files ({} KB, {} KB stored) into {}", files.size(), raw_bytes / 1024, stored_bytes / 1024, output_path.string());
+    return 0;
+}
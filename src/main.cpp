@@ -17,6 +17,8 @@ SDL_AppResult SDL_AppEvent(void* appstate_p, SDL_Event* event_p) {
 SDL_AppResult SDL_AppIterate(void* appstate_p) {
     Engine* engine_p = (Engine*)(appstate_p);
     engine_p->execute_frame();
+    // a failed soak check ends the run with an error
+    if (GlResources::soak_failed()) return SDL_AppResult::SDL_APP_FAILURE;
     return SDL_AppResult::SDL_APP_CONTINUE;
 }
 void SDL_AppQuit(void* appstate_p, SDL_AppResult) {
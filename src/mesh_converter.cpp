@@ -0,0 +1,20 @@
+#include <fmt/base.h>
+#include "mesh_cache.hpp"
+
+// writes the binary mesh cache for every model passed on the command line
+// usage: mesh-converter ../assets/models/Shark.obj ../assets/models/Koi.obj ...
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fmt::println("usage: {} <model> [<model> ...]", argv[0]);
+        return 1;
+    }
+    // paths are taken as given, relative to the working directory
+    Files::init_loose("");
+    int failures = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string source_path = argv[i];
+        if (MeshCache::convert(source_path)) fmt::println("{} -> {}", source_path, MeshCache::cache_path(source_path));
+        else failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}